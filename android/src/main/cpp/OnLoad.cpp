@@ -20,6 +20,7 @@
 #include "V8ExecutorFactory.h"
 #include "V8Runtime.h"
 #include "V8RuntimeConfig.h"
+#include "V8RuntimeFactory.h"
 
 namespace jni = facebook::jni;
 namespace jsi = facebook::jsi;
@@ -70,21 +71,46 @@ class V8ExecutorHolder
       const std::string &deviceName,
       const std::string &snapshotBlobPath,
       int codecacheMode,
-      const std::string &codecacheDir) {
+      const std::string &codecacheDir,
+      bool enableDeferredFinalization,
+      bool enableCppgc,
+      bool enableCustomPlatform,
+      int platformWorkerThreadCount,
+      int platformWorkerThreadPriority,
+      bool enableAsyncTeardown,
+      bool enableIsolateRecycling,
+      int watchdogTimeoutMs,
+      bool watchdogTerminateExecution,
+      bool enableNativeTimers,
+      const std::string &nearHeapLimitSnapshotPath,
+      bool enableGCTelemetry,
+      bool enableGCSystrace,
+      const std::string &v8TraceCategories) {
     react::JReactMarker::setLogPerfMarkerIfNeeded();
 
-    auto config = std::make_unique<V8RuntimeConfig>();
-    config->timezoneId = timezoneId;
-    config->enableInspector = enableInspector;
-    config->appName = appName;
-    config->deviceName = deviceName;
-    if (!snapshotBlobPath.empty()) {
-      config->snapshotBlob =
-          std::move(loadBlob(assetManager, snapshotBlobPath));
-    }
-    config->codecacheMode =
-        static_cast<V8RuntimeConfig::CodecacheMode>(codecacheMode);
-    config->codecacheDir = codecacheDir;
+    auto config = makeConfig(
+        assetManager,
+        timezoneId,
+        enableInspector,
+        appName,
+        deviceName,
+        snapshotBlobPath,
+        codecacheMode,
+        codecacheDir,
+        enableDeferredFinalization,
+        enableCppgc,
+        enableCustomPlatform,
+        platformWorkerThreadCount,
+        platformWorkerThreadPriority,
+        enableAsyncTeardown,
+        enableIsolateRecycling,
+        watchdogTimeoutMs,
+        watchdogTerminateExecution,
+        enableNativeTimers,
+        nearHeapLimitSnapshotPath,
+        enableGCTelemetry,
+        enableGCSystrace,
+        v8TraceCategories);
 
     return makeCxxInstance(folly::make_unique<V8ExecutorFactory>(
         installBindings,
@@ -92,6 +118,55 @@ class V8ExecutorHolder
         std::move(config)));
   }
 
+  static void prewarm(
+      jni::alias_ref<jclass>,
+      jni::alias_ref<react::JAssetManager::javaobject> assetManager,
+      const std::string &timezoneId,
+      bool enableInspector,
+      const std::string &appName,
+      const std::string &deviceName,
+      const std::string &snapshotBlobPath,
+      int codecacheMode,
+      const std::string &codecacheDir,
+      bool enableDeferredFinalization,
+      bool enableCppgc,
+      bool enableCustomPlatform,
+      int platformWorkerThreadCount,
+      int platformWorkerThreadPriority,
+      bool enableAsyncTeardown,
+      bool enableIsolateRecycling,
+      int watchdogTimeoutMs,
+      bool watchdogTerminateExecution,
+      bool enableNativeTimers,
+      const std::string &nearHeapLimitSnapshotPath,
+      bool enableGCTelemetry,
+      bool enableGCSystrace,
+      const std::string &v8TraceCategories) {
+    prewarmV8Runtime(makeConfig(
+        assetManager,
+        timezoneId,
+        enableInspector,
+        appName,
+        deviceName,
+        snapshotBlobPath,
+        codecacheMode,
+        codecacheDir,
+        enableDeferredFinalization,
+        enableCppgc,
+        enableCustomPlatform,
+        platformWorkerThreadCount,
+        platformWorkerThreadPriority,
+        enableAsyncTeardown,
+        enableIsolateRecycling,
+        watchdogTimeoutMs,
+        watchdogTerminateExecution,
+        enableNativeTimers,
+        nearHeapLimitSnapshotPath,
+        enableGCTelemetry,
+        enableGCSystrace,
+        v8TraceCategories));
+  }
+
   static void onMainLoopIdle(
       jni::alias_ref<jclass>,
       jni::alias_ref<facebook::react::JRuntimeExecutor::javaobject>
@@ -104,13 +179,109 @@ class V8ExecutorHolder
     });
   }
 
+  static void startSamplingProfiler(
+      jni::alias_ref<jclass>,
+      int samplingIntervalUs) {
+    V8Executor::StartSamplingProfiler(samplingIntervalUs);
+  }
+
+  static void stopSamplingProfiler(
+      jni::alias_ref<jclass>,
+      const std::string &filename) {
+    V8Executor::StopSamplingProfiler(filename);
+  }
+
+  static void startHeapSamplingProfiler(
+      jni::alias_ref<jclass>,
+      int samplingIntervalBytes) {
+    V8Executor::StartHeapSamplingProfiler(samplingIntervalBytes);
+  }
+
+  static void stopHeapSamplingProfiler(
+      jni::alias_ref<jclass>,
+      const std::string &filename) {
+    V8Executor::StopHeapSamplingProfiler(filename);
+  }
+
+  static void writeHeapSnapshot(
+      jni::alias_ref<jclass>,
+      const std::string &filename) {
+    V8Executor::WriteHeapSnapshot(filename);
+  }
+
   static void registerNatives() {
     registerHybrid({
         makeNativeMethod("initHybrid", V8ExecutorHolder::initHybrid),
+        makeNativeMethod("prewarm", V8ExecutorHolder::prewarm),
         makeNativeMethod("onMainLoopIdle", V8ExecutorHolder::onMainLoopIdle),
+        makeNativeMethod(
+            "startSamplingProfiler", V8ExecutorHolder::startSamplingProfiler),
+        makeNativeMethod(
+            "stopSamplingProfiler", V8ExecutorHolder::stopSamplingProfiler),
+        makeNativeMethod(
+            "startHeapSamplingProfiler",
+            V8ExecutorHolder::startHeapSamplingProfiler),
+        makeNativeMethod(
+            "stopHeapSamplingProfiler",
+            V8ExecutorHolder::stopHeapSamplingProfiler),
+        makeNativeMethod(
+            "writeHeapSnapshot", V8ExecutorHolder::writeHeapSnapshot),
     });
   }
 
+ private:
+  static std::unique_ptr<V8RuntimeConfig> makeConfig(
+      jni::alias_ref<react::JAssetManager::javaobject> assetManager,
+      const std::string &timezoneId,
+      bool enableInspector,
+      const std::string &appName,
+      const std::string &deviceName,
+      const std::string &snapshotBlobPath,
+      int codecacheMode,
+      const std::string &codecacheDir,
+      bool enableDeferredFinalization,
+      bool enableCppgc,
+      bool enableCustomPlatform,
+      int platformWorkerThreadCount,
+      int platformWorkerThreadPriority,
+      bool enableAsyncTeardown,
+      bool enableIsolateRecycling,
+      int watchdogTimeoutMs,
+      bool watchdogTerminateExecution,
+      bool enableNativeTimers,
+      const std::string &nearHeapLimitSnapshotPath,
+      bool enableGCTelemetry,
+      bool enableGCSystrace,
+      const std::string &v8TraceCategories) {
+    auto config = std::make_unique<V8RuntimeConfig>();
+    config->timezoneId = timezoneId;
+    config->enableInspector = enableInspector;
+    config->appName = appName;
+    config->deviceName = deviceName;
+    if (!snapshotBlobPath.empty()) {
+      config->snapshotBlob =
+          std::move(loadBlob(assetManager, snapshotBlobPath));
+    }
+    config->codecacheMode =
+        static_cast<V8RuntimeConfig::CodecacheMode>(codecacheMode);
+    config->codecacheDir = codecacheDir;
+    config->enableDeferredFinalization = enableDeferredFinalization;
+    config->enableCppgc = enableCppgc;
+    config->enableCustomPlatform = enableCustomPlatform;
+    config->platformWorkerThreadCount = platformWorkerThreadCount;
+    config->platformWorkerThreadPriority = platformWorkerThreadPriority;
+    config->enableAsyncTeardown = enableAsyncTeardown;
+    config->enableIsolateRecycling = enableIsolateRecycling;
+    config->watchdogTimeoutMs = static_cast<uint32_t>(watchdogTimeoutMs);
+    config->watchdogTerminateExecution = watchdogTerminateExecution;
+    config->enableNativeTimers = enableNativeTimers;
+    config->nearHeapLimitSnapshotPath = nearHeapLimitSnapshotPath;
+    config->enableGCTelemetry = enableGCTelemetry;
+    config->enableGCSystrace = enableGCSystrace;
+    config->v8TraceCategories = v8TraceCategories;
+    return config;
+  }
+
  private:
   friend HybridBase;
   using HybridBase::HybridBase;
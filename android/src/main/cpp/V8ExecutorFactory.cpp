@@ -8,8 +8,10 @@
 
 #include "V8ExecutorFactory.h"
 
+#include <algorithm>
 #include <thread>
 
+#include "V8Runtime.h"
 #include "V8RuntimeFactory.h"
 #include "cxxreact/MessageQueueThread.h"
 #include "cxxreact/SystraceSection.h"
@@ -33,8 +35,13 @@ std::unique_ptr<jsi::Runtime> makeV8RuntimeSystraced(
 std::unique_ptr<react::JSExecutor> V8ExecutorFactory::createJSExecutor(
     std::shared_ptr<react::ExecutorDelegate> delegate,
     std::shared_ptr<react::MessageQueueThread> jsQueue) {
-  std::unique_ptr<jsi::Runtime> v8Runtime =
-      makeV8RuntimeSystraced(std::move(config_), jsQueue);
+  std::unique_ptr<jsi::Runtime> v8Runtime;
+  if (config_) {
+    v8Runtime = takePrewarmedV8Runtime(*config_, jsQueue);
+  }
+  if (!v8Runtime) {
+    v8Runtime = makeV8RuntimeSystraced(std::move(config_), jsQueue);
+  }
 
   // Add js engine information to Error.prototype so in error reporting we
   // can send this information.
@@ -57,6 +64,76 @@ V8Executor::V8Executor(
     std::shared_ptr<react::MessageQueueThread> jsQueue,
     const react::JSIScopedTimeoutInvoker &timeoutInvoker,
     RuntimeInstaller runtimeInstaller)
-    : JSIExecutor(runtime, delegate, timeoutInvoker, runtimeInstaller) {}
+    : JSIExecutor(runtime, delegate, timeoutInvoker, runtimeInstaller) {
+  std::lock_guard<std::mutex> lock(s_currentExecutorMutex);
+  s_currentRuntime = runtime;
+  s_currentJSQueue = jsQueue;
+}
+
+// static
+std::mutex V8Executor::s_currentExecutorMutex;
+
+// static
+std::weak_ptr<jsi::Runtime> V8Executor::s_currentRuntime;
+
+// static
+std::weak_ptr<react::MessageQueueThread> V8Executor::s_currentJSQueue;
+
+// static
+void V8Executor::StartSamplingProfiler(int samplingIntervalUs) {
+  RunOnCurrentRuntime([samplingIntervalUs](V8Runtime &runtime) {
+    runtime.StartCpuProfiler(samplingIntervalUs);
+  });
+}
+
+// static
+void V8Executor::StopSamplingProfiler(const std::string &filename) {
+  RunOnCurrentRuntime([filename](V8Runtime &runtime) {
+    runtime.StopCpuProfiler(filename);
+  });
+}
+
+// static
+void V8Executor::StartHeapSamplingProfiler(int samplingIntervalBytes) {
+  RunOnCurrentRuntime([samplingIntervalBytes](V8Runtime &runtime) {
+    runtime.StartHeapSamplingProfiler(
+        static_cast<uint64_t>(std::max(samplingIntervalBytes, 0)));
+  });
+}
+
+// static
+void V8Executor::StopHeapSamplingProfiler(const std::string &filename) {
+  RunOnCurrentRuntime([filename](V8Runtime &runtime) {
+    runtime.StopHeapSamplingProfiler(filename);
+  });
+}
+
+// static
+void V8Executor::WriteHeapSnapshot(const std::string &filename) {
+  RunOnCurrentRuntime(
+      [filename](V8Runtime &runtime) { runtime.WriteHeapSnapshot(filename); });
+}
+
+// static
+void V8Executor::RunOnCurrentRuntime(
+    std::function<void(V8Runtime &)> &&task) {
+  std::weak_ptr<jsi::Runtime> weakRuntime;
+  std::shared_ptr<react::MessageQueueThread> jsQueue;
+  {
+    std::lock_guard<std::mutex> lock(s_currentExecutorMutex);
+    weakRuntime = s_currentRuntime;
+    jsQueue = s_currentJSQueue.lock();
+  }
+  if (!jsQueue) {
+    return;
+  }
+  jsQueue->runOnQueue(
+      [weakRuntime = std::move(weakRuntime), task = std::move(task)]() {
+        std::shared_ptr<jsi::Runtime> runtime = weakRuntime.lock();
+        if (auto *v8Runtime = dynamic_cast<V8Runtime *>(runtime.get())) {
+          task(*v8Runtime);
+        }
+      });
+}
 
 } // namespace rnv8
@@ -9,10 +9,14 @@
 #pragma once
 
 #include <jsireact/JSIExecutor.h>
+#include <functional>
+#include <mutex>
 #include "V8RuntimeConfig.h"
 
 namespace rnv8 {
 
+class V8Runtime;
+
 class V8ExecutorFactory : public facebook::react::JSExecutorFactory {
  public:
   explicit V8ExecutorFactory(
@@ -44,7 +48,22 @@ class V8Executor : public facebook::react::JSIExecutor {
       const facebook::react::JSIScopedTimeoutInvoker &timeoutInvoker,
       RuntimeInstaller runtimeInstaller);
 
+  // Profiling of the most recently created executor, run on its JS thread
+  static void StartSamplingProfiler(int samplingIntervalUs);
+  static void StopSamplingProfiler(const std::string &filename);
+  static void StartHeapSamplingProfiler(int samplingIntervalBytes);
+  static void StopHeapSamplingProfiler(const std::string &filename);
+  static void WriteHeapSnapshot(const std::string &filename);
+
  private:
+  // Runs `task` on the JS thread with the runtime of the current executor
+  static void RunOnCurrentRuntime(std::function<void(V8Runtime &)> &&task);
+
+ private:
+  static std::mutex s_currentExecutorMutex; // protects s_current*
+  static std::weak_ptr<facebook::jsi::Runtime> s_currentRuntime;
+  static std::weak_ptr<facebook::react::MessageQueueThread> s_currentJSQueue;
+
   facebook::react::JSIScopedTimeoutInvoker timeoutInvoker_;
 };
 
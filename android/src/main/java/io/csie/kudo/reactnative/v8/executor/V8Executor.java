@@ -32,7 +32,57 @@ public class V8Executor extends JavaScriptExecutor {
                                         : loadDefaultSnapshotBlobPath(),
         config.codecacheMode,
         config.codecacheDir != null ? config.codecacheDir
-                                    : context.getCodeCacheDir().toString()));
+                                    : context.getCodeCacheDir().toString(),
+        config.enableDeferredFinalization,
+        config.enableCppgc,
+        config.enableCustomPlatform,
+        config.platformWorkerThreadCount,
+        config.platformWorkerThreadPriority,
+        config.enableAsyncTeardown,
+        config.enableIsolateRecycling,
+        config.watchdogTimeoutMs,
+        config.watchdogTerminateExecution,
+        config.enableNativeTimers,
+        config.nearHeapLimitSnapshotPath != null
+            ? config.nearHeapLimitSnapshotPath : "",
+        config.enableGCTelemetry,
+        config.enableGCSystrace,
+        config.v8TraceCategories != null ? config.v8TraceCategories : ""));
+  }
+
+  /**
+   * Creates a runtime with the given config on a background thread. The next
+   * V8Executor adopts it instead of creating its own runtime.
+   */
+  /* package */ static void prewarm(
+      final Context context,
+      final V8RuntimeConfig config) {
+    prewarm(
+        context.getAssets(),
+        config.timezoneId,
+        config.enableInspector,
+        config.appName,
+        config.deviceName,
+        config.snapshotBlobPath != null ? config.snapshotBlobPath
+                                        : loadDefaultSnapshotBlobPath(),
+        config.codecacheMode,
+        config.codecacheDir != null ? config.codecacheDir
+                                    : context.getCodeCacheDir().toString(),
+        config.enableDeferredFinalization,
+        config.enableCppgc,
+        config.enableCustomPlatform,
+        config.platformWorkerThreadCount,
+        config.platformWorkerThreadPriority,
+        config.enableAsyncTeardown,
+        config.enableIsolateRecycling,
+        config.watchdogTimeoutMs,
+        config.watchdogTerminateExecution,
+        config.enableNativeTimers,
+        config.nearHeapLimitSnapshotPath != null
+            ? config.nearHeapLimitSnapshotPath : "",
+        config.enableGCTelemetry,
+        config.enableGCSystrace,
+        config.v8TraceCategories != null ? config.v8TraceCategories : "");
   }
 
   @Override
@@ -55,8 +105,58 @@ public class V8Executor extends JavaScriptExecutor {
       String deviceName,
       String snapshotBlobPath,
       int codecacheMode,
-      String codecacheDir);
+      String codecacheDir,
+      boolean enableDeferredFinalization,
+      boolean enableCppgc,
+      boolean enableCustomPlatform,
+      int platformWorkerThreadCount,
+      int platformWorkerThreadPriority,
+      boolean enableAsyncTeardown,
+      boolean enableIsolateRecycling,
+      int watchdogTimeoutMs,
+      boolean watchdogTerminateExecution,
+      boolean enableNativeTimers,
+      String nearHeapLimitSnapshotPath,
+      boolean enableGCTelemetry,
+      boolean enableGCSystrace,
+      String v8TraceCategories);
+
+  private static native void prewarm(
+      AssetManager assetManager,
+      String timezoneId,
+      boolean enableInspector,
+      String appName,
+      String deviceName,
+      String snapshotBlobPath,
+      int codecacheMode,
+      String codecacheDir,
+      boolean enableDeferredFinalization,
+      boolean enableCppgc,
+      boolean enableCustomPlatform,
+      int platformWorkerThreadCount,
+      int platformWorkerThreadPriority,
+      boolean enableAsyncTeardown,
+      boolean enableIsolateRecycling,
+      int watchdogTimeoutMs,
+      boolean watchdogTerminateExecution,
+      boolean enableNativeTimers,
+      String nearHeapLimitSnapshotPath,
+      boolean enableGCTelemetry,
+      boolean enableGCSystrace,
+      String v8TraceCategories);
 
   /* package */ static native void onMainLoopIdle(
       RuntimeExecutor runtimeExecutor);
+
+  /* package */ static native void startSamplingProfiler(
+      int samplingIntervalUs);
+
+  /* package */ static native void stopSamplingProfiler(String filename);
+
+  /* package */ static native void startHeapSamplingProfiler(
+      int samplingIntervalBytes);
+
+  /* package */ static native void stopHeapSamplingProfiler(String filename);
+
+  /* package */ static native void writeHeapSnapshot(String filename);
 }
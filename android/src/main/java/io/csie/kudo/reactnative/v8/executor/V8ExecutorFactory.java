@@ -45,6 +45,17 @@ public class V8ExecutorFactory implements JavaScriptExecutorFactory {
     mConfig = config;
   }
 
+  /**
+   * Prewarms a V8 runtime on a background thread, e.g. from
+   * `Application.onCreate()`. The first executor created afterwards adopts the
+   * prewarmed runtime, so `config` should match the factory's config.
+   */
+  public static void prewarm(
+      final Context context,
+      final V8RuntimeConfig config) {
+    V8Executor.prewarm(context, config);
+  }
+
   @Override
   public JavaScriptExecutor create() {
     return new V8Executor(mContext, mConfig);
@@ -52,14 +63,41 @@ public class V8ExecutorFactory implements JavaScriptExecutorFactory {
 
   @Override
   public void startSamplingProfiler() {
-    throw new UnsupportedOperationException(
-        "Starting sampling profiler not supported on " + toString());
+    V8Executor.startSamplingProfiler(mConfig.samplingProfilerIntervalUs);
   }
 
+  /**
+   * Stops the sampling profiler and writes a .cpuprofile to `filename`. The
+   * profile is written asynchronously on the JS thread.
+   */
   @Override
   public void stopSamplingProfiler(String filename) {
-    throw new UnsupportedOperationException(
-        "Stopping sampling profiler not supported on " + toString());
+    V8Executor.stopSamplingProfiler(filename);
+  }
+
+  /**
+   * Starts the sampling heap profiler of the current runtime to record
+   * allocation sites at low overhead.
+   */
+  public void startHeapSamplingProfiler() {
+    V8Executor.startHeapSamplingProfiler(
+        mConfig.heapSamplingProfilerIntervalBytes);
+  }
+
+  /**
+   * Stops the sampling heap profiler and writes a .heapprofile to `filename`.
+   * The profile is written asynchronously on the JS thread.
+   */
+  public void stopHeapSamplingProfiler(String filename) {
+    V8Executor.stopHeapSamplingProfiler(filename);
+  }
+
+  /**
+   * Writes a .heapsnapshot of the current runtime to `filename`. The snapshot
+   * is taken asynchronously on the JS thread.
+   */
+  public void writeHeapSnapshot(String filename) {
+    V8Executor.writeHeapSnapshot(filename);
   }
 
   @Override
@@ -50,6 +50,66 @@ public final class V8RuntimeConfig {
   // The directory to store codecache files
   @Nullable public String codecacheDir;
 
+  // true to destroy HostObject/HostFunction/NativeState payloads on the JS
+  // thread when it is idle instead of inside GC weak callbacks
+  public boolean enableDeferredFinalization;
+
+  // true to keep HostObject/NativeState wrappers on the V8 unified heap
+  // (cppgc) instead of weak global handles
+  public boolean enableCppgc;
+
+  // true to run V8 foreground tasks directly on the JS queue and background
+  // tasks on a priority aware worker pool instead of the default platform
+  public boolean enableCustomPlatform;
+
+  // Number of platform worker threads, 0 to use the number of cores - 1
+  public int platformWorkerThreadCount;
+
+  // Nice value of platform worker threads
+  public int platformWorkerThreadPriority;
+
+  // true to dispose the isolate on a background thread when the runtime is
+  // destroyed, so reloads don't block while the heap is freed
+  public boolean enableAsyncTeardown;
+
+  // true to keep the isolate when the runtime is destroyed and reuse it with
+  // a fresh context after reloading
+  public boolean enableIsolateRecycling;
+
+  // Milliseconds a JS call may run before the watchdog logs a long task report
+  // with the JS stack, 0 to disable the watchdog
+  public int watchdogTimeoutMs;
+
+  // true to also terminate the JS execution when the watchdog fires
+  public boolean watchdogTerminateExecution;
+
+  // true to install native setTimeout/setInterval/requestIdleCallback run on
+  // the JS queue. React Native's timer polyfill replaces them once
+  // `InitializeCore` runs, so they only serve code evaluated before it.
+  public boolean enableNativeTimers;
+
+  // Sampling interval of the sampling profiler in microseconds, 0 to use the
+  // V8 default
+  public int samplingProfilerIntervalUs;
+
+  // Average bytes between samples of the sampling heap profiler, 0 to use the
+  // V8 default
+  public int heapSamplingProfilerIntervalBytes;
+
+  // When not null, a heap snapshot is written to this path the first time the
+  // heap gets close to its limit
+  @Nullable public String nearHeapLimitSnapshotPath;
+
+  // Records the GC pauses, exposed as `global._v8runtime().gc`
+  public boolean enableGCTelemetry;
+
+  // Emits a systrace section for every GC, requires `enableGCTelemetry`
+  public boolean enableGCSystrace;
+
+  // Comma separated V8 trace categories emitted as systrace sections, e.g.
+  // "v8,v8.compile". Only the first runtime applies it.
+  @Nullable public String v8TraceCategories;
+
   public static V8RuntimeConfig createDefault() {
     final V8RuntimeConfig config = new V8RuntimeConfig();
     config.timezoneId = getTimezoneId();
@@ -57,6 +117,22 @@ public final class V8RuntimeConfig {
     config.snapshotBlobPath = null;
     config.codecacheMode = CODECACHE_MODE_NONE;
     config.codecacheDir = null;
+    config.enableDeferredFinalization = false;
+    config.enableCppgc = false;
+    config.enableCustomPlatform = false;
+    config.platformWorkerThreadCount = 0;
+    config.platformWorkerThreadPriority = 0;
+    config.enableAsyncTeardown = false;
+    config.enableIsolateRecycling = false;
+    config.watchdogTimeoutMs = 0;
+    config.watchdogTerminateExecution = false;
+    config.enableNativeTimers = false;
+    config.samplingProfilerIntervalUs = 0;
+    config.heapSamplingProfilerIntervalBytes = 0;
+    config.nearHeapLimitSnapshotPath = null;
+    config.enableGCTelemetry = false;
+    config.enableGCSystrace = false;
+    config.v8TraceCategories = null;
     return config;
   }
 
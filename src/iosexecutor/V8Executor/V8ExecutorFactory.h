@@ -13,9 +13,12 @@ namespace rnv8 {
 
 class V8ExecutorFactory : public facebook::react::JSExecutorFactory {
  public:
+  // `enableNativeTimers` maps to `V8RuntimeConfig::enableNativeTimers`
   explicit V8ExecutorFactory(
-      facebook::react::JSIExecutor::RuntimeInstaller runtimeInstaller)
-      : runtimeInstaller_(std::move(runtimeInstaller)) {}
+      facebook::react::JSIExecutor::RuntimeInstaller runtimeInstaller,
+      bool enableNativeTimers = false)
+      : runtimeInstaller_(std::move(runtimeInstaller)),
+        enableNativeTimers_(enableNativeTimers) {}
 
   std::unique_ptr<facebook::react::JSExecutor> createJSExecutor(
       std::shared_ptr<facebook::react::ExecutorDelegate> delegate,
@@ -23,6 +26,7 @@ class V8ExecutorFactory : public facebook::react::JSExecutorFactory {
 
  private:
   facebook::react::JSIExecutor::RuntimeInstaller runtimeInstaller_;
+  bool enableNativeTimers_;
 };
 
 } // namespace rnv8
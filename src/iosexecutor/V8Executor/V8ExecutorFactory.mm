@@ -32,8 +32,13 @@ std::unique_ptr<react::JSExecutor> V8ExecutorFactory::createJSExecutor(
   };
   auto config = std::make_unique<V8RuntimeConfig>();
   config->enableInspector = true;
+  config->enableNativeTimers = enableNativeTimers_;
+  std::unique_ptr<jsi::Runtime> v8Runtime = takePrewarmedV8Runtime(*config, jsQueue);
+  if (!v8Runtime) {
+    v8Runtime = createV8Runtime(std::move(config), jsQueue);
+  }
   return folly::make_unique<react::JSIExecutor>(
-      createV8Runtime(std::move(config), jsQueue),
+      std::move(v8Runtime),
       delegate,
       react::JSIExecutor::defaultTimeoutInvoker,
       std::move(installBindings));
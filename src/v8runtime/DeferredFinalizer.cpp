@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "DeferredFinalizer.h"
+
+namespace rnv8 {
+
+void DeferredFinalizer::Release(std::shared_ptr<void> object) {
+  if (!object) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.push_back(std::move(object));
+  ++pendingCount_;
+}
+
+void DeferredFinalizer::Drain() {
+  while (true) {
+    std::deque<std::shared_ptr<void>> objects;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.empty()) {
+        return;
+      }
+      objects.swap(queue_);
+    }
+
+    // Destructors run without holding the queue lock, as they may release
+    // more payloads.
+    size_t count = objects.size();
+    objects.clear();
+    pendingCount_ -= count;
+    finalizedCount_ += count;
+  }
+}
+
+size_t DeferredFinalizer::GetPendingCount() const {
+  return pendingCount_.load(std::memory_order_relaxed);
+}
+
+size_t DeferredFinalizer::GetFinalizedCount() const {
+  return finalizedCount_.load(std::memory_order_relaxed);
+}
+
+} // namespace rnv8
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace rnv8 {
+
+// Holds native payloads released from GC weak callbacks until the next idle
+// slot of the JS thread, so expensive destructors don't lengthen GC pauses.
+// Payloads often hold jsi values, e.g. the captures of a HostFunction, which
+// lock the isolate when released, so they are not destroyed on another
+// thread.
+class DeferredFinalizer {
+ public:
+  DeferredFinalizer() = default;
+
+  DeferredFinalizer(const DeferredFinalizer &) = delete;
+  DeferredFinalizer &operator=(const DeferredFinalizer &) = delete;
+
+  // Queues the object for destruction in the next `Drain()`.
+  // Safe to call from GC weak callbacks.
+  void Release(std::shared_ptr<void> object);
+
+  // Destroys the queued objects on the calling thread, including the ones
+  // released by their destructors. Called on the JS thread.
+  void Drain();
+
+  size_t GetPendingCount() const;
+  size_t GetFinalizedCount() const;
+
+ private:
+  std::mutex mutex_; // protects queue_
+  std::deque<std::shared_ptr<void>> queue_;
+
+  std::atomic<size_t> pendingCount_{0};
+  std::atomic<size_t> finalizedCount_{0};
+};
+
+} // namespace rnv8
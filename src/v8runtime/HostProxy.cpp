@@ -7,17 +7,48 @@
 
 #include "HostProxy.h"
 
+#include <cxxreact/SystraceSection.h>
+#include <atomic>
+#include "DeferredFinalizer.h"
 #include "JSIV8ValueConverter.h"
 
 namespace jsi = facebook::jsi;
 
 namespace rnv8 {
 
+namespace {
+
+std::atomic<size_t> s_liveHostObjects{0};
+std::atomic<size_t> s_liveNativeStates{0};
+
+// Creates the Error directly in V8, calling the JS `Error` constructor through
+// JSI would fail again when the exception came from a terminating execution
+void ThrowError(v8::Isolate *isolate, const std::string &message) {
+  isolate->ThrowException(v8::Exception::Error(
+      v8::String::NewFromUtf8(
+          isolate,
+          message.c_str(),
+          v8::NewStringType::kNormal,
+          static_cast<int>(message.length()))
+          .ToLocalChecked()));
+}
+
+} // namespace
+
 HostObjectProxy::HostObjectProxy(
     V8Runtime &runtime,
     v8::Isolate *isolate,
     std::shared_ptr<jsi::HostObject> hostObject)
-    : runtime_(runtime), isolate_(isolate), hostObject_(hostObject) {}
+    : runtime_(runtime),
+      isolate_(isolate),
+      hostObject_(hostObject),
+      traceable_(dynamic_cast<const CppgcTraceable *>(hostObject.get())) {
+  s_liveHostObjects.fetch_add(1, std::memory_order_relaxed);
+}
+
+HostObjectProxy::~HostObjectProxy() {
+  s_liveHostObjects.fetch_sub(1, std::memory_order_relaxed);
+}
 
 void HostObjectProxy::BindFinalizer(const v8::Local<v8::Object> &object) {
   v8::HandleScope scopedHandle(isolate_);
@@ -29,52 +60,80 @@ std::shared_ptr<jsi::HostObject> HostObjectProxy::GetHostObject() {
   return hostObject_;
 }
 
+void HostObjectProxy::Trace(cppgc::Visitor *visitor) const {
+  if (traceable_) {
+    traceable_->Trace(visitor);
+  }
+}
+
+void HostObjectProxy::ReleaseFromUnifiedHeap() {
+  runtime_.ReleaseSweptPayload(std::move(hostObject_));
+  delete this;
+}
+
+// static
+size_t HostObjectProxy::GetLiveCount() {
+  return s_liveHostObjects.load(std::memory_order_relaxed);
+}
+
+// static
+HostObjectProxy *HostObjectProxy::FromObject(
+    v8::Isolate *isolate,
+    v8::Local<v8::Object> object) {
+  if (isolate->GetCppHeap()) {
+    return reinterpret_cast<ProxyWrappable<HostObjectProxy> *>(
+               object->GetAlignedPointerFromInternalField(1))
+        ->Get();
+  }
+  v8::Local<v8::External> data =
+      v8::Local<v8::External>::Cast(object->GetInternalField(1));
+  return reinterpret_cast<HostObjectProxy *>(data->Value());
+}
+
 // static
 void HostObjectProxy::Getter(
     v8::Local<v8::Name> property,
     const v8::PropertyCallbackInfo<v8::Value> &info) {
   v8::HandleScope scopedHandle(info.GetIsolate());
-  v8::Local<v8::External> data =
-      v8::Local<v8::External>::Cast(info.This()->GetInternalField(1));
   HostObjectProxy *hostObjectProxy =
-      reinterpret_cast<HostObjectProxy *>(data->Value());
+      HostObjectProxy::FromObject(info.GetIsolate(), info.This());
 
   assert(hostObjectProxy);
 
   auto &runtime = hostObjectProxy->runtime_;
   jsi::PropNameID sym = JSIV8ValueConverter::ToJSIPropNameID(runtime, property);
+  RNV8_INSTRUMENT_NAMED(
+      "HostObject.get:" +
+      JSIV8ValueConverter::ToSTLString(info.GetIsolate(), property));
   jsi::Value ret;
   try {
     ret = hostObjectProxy->hostObject_->get(runtime, sym);
   } catch (const jsi::JSError &error) {
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
     info.GetIsolate()->ThrowException(
         JSIV8ValueConverter::ToV8Value(runtime, error.value()));
     return;
   } catch (const std::exception &ex) {
-    auto excValue =
-        runtime.global()
-            .getPropertyAsFunction(runtime, "Error")
-            .call(
-                runtime,
-                std::string("Exception in HostObject::get(property:") +
-                    JSIV8ValueConverter::ToSTLString(
-                        info.GetIsolate(), property) +
-                    std::string("): ") + ex.what());
-    info.GetIsolate()->ThrowException(
-        JSIV8ValueConverter::ToV8Value(runtime, excValue));
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
+    ThrowError(
+        info.GetIsolate(),
+        std::string("Exception in HostObject::get(property:") +
+            JSIV8ValueConverter::ToSTLString(info.GetIsolate(), property) +
+            std::string("): ") + ex.what());
     return;
   } catch (...) {
-    auto excValue =
-        runtime.global()
-            .getPropertyAsFunction(runtime, "Error")
-            .call(
-                runtime,
-                std::string("Exception in HostObject::get(property:") +
-                    JSIV8ValueConverter::ToSTLString(
-                        info.GetIsolate(), property) +
-                    std::string("): <unknown>"));
-    info.GetIsolate()->ThrowException(
-        JSIV8ValueConverter::ToV8Value(runtime, excValue));
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
+    ThrowError(
+        info.GetIsolate(),
+        std::string("Exception in HostObject::get(property:") +
+            JSIV8ValueConverter::ToSTLString(info.GetIsolate(), property) +
+            std::string("): <unknown>"));
     return;
   }
   info.GetReturnValue().Set(JSIV8ValueConverter::ToV8Value(runtime, ret));
@@ -86,48 +145,46 @@ void HostObjectProxy::Setter(
     v8::Local<v8::Value> value,
     const v8::PropertyCallbackInfo<v8::Value> &info) {
   v8::HandleScope scopedHandle(info.GetIsolate());
-  v8::Local<v8::External> data =
-      v8::Local<v8::External>::Cast(info.This()->GetInternalField(1));
   HostObjectProxy *hostObjectProxy =
-      reinterpret_cast<HostObjectProxy *>(data->Value());
+      HostObjectProxy::FromObject(info.GetIsolate(), info.This());
 
   assert(hostObjectProxy);
   auto &runtime = hostObjectProxy->runtime_;
   jsi::PropNameID sym = JSIV8ValueConverter::ToJSIPropNameID(runtime, property);
+  RNV8_INSTRUMENT_NAMED(
+      "HostObject.set:" +
+      JSIV8ValueConverter::ToSTLString(info.GetIsolate(), property));
   try {
     hostObjectProxy->hostObject_->set(
         runtime,
         sym,
         JSIV8ValueConverter::ToJSIValue(info.GetIsolate(), value));
   } catch (const jsi::JSError &error) {
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
     info.GetIsolate()->ThrowException(
         JSIV8ValueConverter::ToV8Value(runtime, error.value()));
     return;
   } catch (const std::exception &ex) {
-    auto excValue =
-        runtime.global()
-            .getPropertyAsFunction(runtime, "Error")
-            .call(
-                runtime,
-                std::string("Exception in HostObject::set(property:") +
-                    JSIV8ValueConverter::ToSTLString(
-                        info.GetIsolate(), property) +
-                    std::string("): ") + ex.what());
-    info.GetIsolate()->ThrowException(
-        JSIV8ValueConverter::ToV8Value(runtime, excValue));
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
+    ThrowError(
+        info.GetIsolate(),
+        std::string("Exception in HostObject::set(property:") +
+            JSIV8ValueConverter::ToSTLString(info.GetIsolate(), property) +
+            std::string("): ") + ex.what());
     return;
   } catch (...) {
-    auto excValue =
-        runtime.global()
-            .getPropertyAsFunction(runtime, "Error")
-            .call(
-                runtime,
-                std::string("Exception in HostObject::set(property:") +
-                    JSIV8ValueConverter::ToSTLString(
-                        info.GetIsolate(), property) +
-                    std::string("): <unknown>"));
-    info.GetIsolate()->ThrowException(
-        JSIV8ValueConverter::ToV8Value(runtime, excValue));
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
+    ThrowError(
+        info.GetIsolate(),
+        std::string("Exception in HostObject::set(property:") +
+            JSIV8ValueConverter::ToSTLString(info.GetIsolate(), property) +
+            std::string("): <unknown>"));
     return;
   }
   return;
@@ -137,10 +194,8 @@ void HostObjectProxy::Setter(
 void HostObjectProxy::Enumerator(
     const v8::PropertyCallbackInfo<v8::Array> &info) {
   v8::HandleScope scopedHandle(info.GetIsolate());
-  v8::Local<v8::External> data =
-      v8::Local<v8::External>::Cast(info.This()->GetInternalField(1));
   HostObjectProxy *hostObjectProxy =
-      reinterpret_cast<HostObjectProxy *>(data->Value());
+      HostObjectProxy::FromObject(info.GetIsolate(), info.This());
 
   assert(hostObjectProxy);
 
@@ -167,7 +222,9 @@ void HostObjectProxy::Enumerator(
 void HostObjectProxy::Finalizer(
     const v8::WeakCallbackInfo<HostObjectProxy> &data) {
   auto *pThis = data.GetParameter();
-  if (pThis->hostObject_.use_count() == 1) {
+  if (pThis->runtime_.deferredFinalizer_) {
+    pThis->runtime_.deferredFinalizer_->Release(std::move(pThis->hostObject_));
+  } else if (pThis->hostObject_.use_count() == 1) {
     pThis->hostObject_.reset();
   }
   pThis->weakHandle_.Reset();
@@ -192,10 +249,22 @@ jsi::HostFunctionType &HostFunctionProxy::GetHostFunction() {
   return hostFunction_;
 }
 
+#if RNV8_ENABLE_INSTRUMENTATION
+void HostFunctionProxy::SetInstrumentationName(std::string name) {
+  instrumentationName_ = std::move(name);
+}
+#endif
+
 // static
 void HostFunctionProxy::Finalizer(
     const v8::WeakCallbackInfo<HostFunctionProxy> &data) {
   auto *pThis = data.GetParameter();
+  if (pThis->runtime_.deferredFinalizer_ && pThis->hostFunction_) {
+    // Captures of the HostFunction are destroyed along with the moved holder
+    pThis->runtime_.deferredFinalizer_->Release(
+        std::make_shared<jsi::HostFunctionType>(
+            std::move(pThis->hostFunction_)));
+  }
   pThis->weakHandle_.Reset();
   delete pThis;
 }
@@ -232,36 +301,100 @@ void HostFunctionProxy::FunctionCallback(
   v8::Local<v8::Value> result;
   jsi::Value thisVal(
       JSIV8ValueConverter::ToJSIValue(info.GetIsolate(), info.This()));
+  facebook::react::SystraceSection s("HostFunction");
+  RNV8_INSTRUMENT_NAMED(hostFunctionProxy->instrumentationName_);
   try {
     result = JSIV8ValueConverter::ToV8Value(
         runtime,
         hostFunctionProxy->hostFunction_(
             runtime, thisVal, args, argumentCount));
   } catch (const jsi::JSError &error) {
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
     info.GetIsolate()->ThrowException(
         JSIV8ValueConverter::ToV8Value(runtime, error.value()));
     return;
   } catch (const std::exception &ex) {
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
     std::string exceptionString("Exception in HostFunction: ");
     exceptionString += ex.what();
-    auto excValue = runtime.global()
-                        .getPropertyAsFunction(runtime, "Error")
-                        .call(runtime, exceptionString);
-
-    info.GetIsolate()->ThrowException(
-        JSIV8ValueConverter::ToV8Value(runtime, excValue));
+    ThrowError(info.GetIsolate(), exceptionString);
     return;
   } catch (...) {
-    std::string exceptionString("Exception in HostFunction: <unknown>");
-    auto excValue = runtime.global()
-                        .getPropertyAsFunction(runtime, "Error")
-                        .call(runtime, exceptionString);
-
-    info.GetIsolate()->ThrowException(
-        JSIV8ValueConverter::ToV8Value(runtime, excValue));
+    if (info.GetIsolate()->IsExecutionTerminating()) {
+      return;
+    }
+    ThrowError(info.GetIsolate(), "Exception in HostFunction: <unknown>");
     return;
   }
   info.GetReturnValue().Set(result);
 }
 
+NativeStateProxy::NativeStateProxy(
+    V8Runtime &runtime,
+    v8::Isolate *isolate,
+    std::shared_ptr<jsi::NativeState> nativeState)
+    : runtime_(runtime),
+      isolate_(isolate),
+      nativeState_(std::move(nativeState)),
+      traceable_(dynamic_cast<const CppgcTraceable *>(nativeState_.get())) {
+  s_liveNativeStates.fetch_add(1, std::memory_order_relaxed);
+}
+
+NativeStateProxy::~NativeStateProxy() {
+  s_liveNativeStates.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void NativeStateProxy::BindFinalizer(const v8::Local<v8::Object> &object) {
+  v8::HandleScope scopedHandle(isolate_);
+  weakHandle_.Reset(isolate_, object);
+  weakHandle_.SetWeak(this, Finalizer, v8::WeakCallbackType::kParameter);
+}
+
+std::shared_ptr<jsi::NativeState> NativeStateProxy::GetNativeState() {
+  return nativeState_;
+}
+
+void NativeStateProxy::Trace(cppgc::Visitor *visitor) const {
+  if (traceable_) {
+    traceable_->Trace(visitor);
+  }
+}
+
+void NativeStateProxy::ReleaseFromUnifiedHeap() {
+  runtime_.ReleaseSweptPayload(std::move(nativeState_));
+  delete this;
+}
+
+// static
+size_t NativeStateProxy::GetLiveCount() {
+  return s_liveNativeStates.load(std::memory_order_relaxed);
+}
+
+// static
+NativeStateProxy *NativeStateProxy::FromObject(
+    v8::Isolate *isolate,
+    v8::Local<v8::Object> object) {
+  void *field = object->GetAlignedPointerFromInternalField(1);
+  if (isolate->GetCppHeap()) {
+    return reinterpret_cast<ProxyWrappable<NativeStateProxy> *>(field)->Get();
+  }
+  return reinterpret_cast<NativeStateProxy *>(field);
+}
+
+// static
+void NativeStateProxy::Finalizer(
+    const v8::WeakCallbackInfo<NativeStateProxy> &data) {
+  auto *pThis = data.GetParameter();
+  if (pThis->runtime_.deferredFinalizer_) {
+    pThis->runtime_.deferredFinalizer_->Release(
+        std::move(pThis->nativeState_));
+  }
+  pThis->weakHandle_.Reset();
+  delete pThis;
+}
+
 } // namespace rnv8
@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include "V8Instrumentation.h"
 #include "V8Runtime.h"
+#include "cppgc/garbage-collected.h"
+#include "cppgc/visitor.h"
 #include "jsi/jsi.h"
 #include "v8.h"
 
@@ -19,12 +22,24 @@ class HostObjectProxy {
       V8Runtime &runtime,
       v8::Isolate *isolate,
       std::shared_ptr<facebook::jsi::HostObject> hostObject);
+  ~HostObjectProxy();
 
   void BindFinalizer(const v8::Local<v8::Object> &object);
 
   std::shared_ptr<facebook::jsi::HostObject> GetHostObject();
 
+  void Trace(cppgc::Visitor *visitor) const;
+
+  void ReleaseFromUnifiedHeap();
+
  public:
+  // Number of instances not yet released, across all runtimes
+  static size_t GetLiveCount();
+
+  static HostObjectProxy *FromObject(
+      v8::Isolate *isolate,
+      v8::Local<v8::Object> object);
+
   static void Getter(
       v8::Local<v8::Name> property,
       const v8::PropertyCallbackInfo<v8::Value> &info);
@@ -42,6 +57,7 @@ class HostObjectProxy {
   V8Runtime &runtime_;
   v8::Isolate *isolate_;
   std::shared_ptr<facebook::jsi::HostObject> hostObject_;
+  const CppgcTraceable *traceable_;
   v8::Global<v8::Object> weakHandle_;
 };
 
@@ -56,6 +72,10 @@ class HostFunctionProxy {
 
   facebook::jsi::HostFunctionType &GetHostFunction();
 
+#if RNV8_ENABLE_INSTRUMENTATION
+  void SetInstrumentationName(std::string name);
+#endif
+
  public:
   static void Finalizer(const v8::WeakCallbackInfo<HostFunctionProxy> &data);
 
@@ -66,6 +86,66 @@ class HostFunctionProxy {
   v8::Isolate *isolate_;
   facebook::jsi::HostFunctionType hostFunction_;
   v8::Global<v8::Object> weakHandle_;
+#if RNV8_ENABLE_INSTRUMENTATION
+  std::string instrumentationName_;
+#endif
+};
+
+class NativeStateProxy {
+ public:
+  NativeStateProxy(
+      V8Runtime &runtime,
+      v8::Isolate *isolate,
+      std::shared_ptr<facebook::jsi::NativeState> nativeState);
+  ~NativeStateProxy();
+
+  void BindFinalizer(const v8::Local<v8::Object> &object);
+
+  std::shared_ptr<facebook::jsi::NativeState> GetNativeState();
+
+  void Trace(cppgc::Visitor *visitor) const;
+
+  void ReleaseFromUnifiedHeap();
+
+ public:
+  // Number of instances not yet released, across all runtimes
+  static size_t GetLiveCount();
+
+  static NativeStateProxy *FromObject(
+      v8::Isolate *isolate,
+      v8::Local<v8::Object> object);
+
+  static void Finalizer(const v8::WeakCallbackInfo<NativeStateProxy> &data);
+
+ private:
+  V8Runtime &runtime_;
+  v8::Isolate *isolate_;
+  std::shared_ptr<facebook::jsi::NativeState> nativeState_;
+  const CppgcTraceable *traceable_;
+  v8::Global<v8::Object> weakHandle_;
+};
+
+// Keeps a HostObjectProxy or NativeStateProxy alive from the V8 unified heap
+// when `enableCppgc` is on, instead of a weak global handle per object.
+template <typename Proxy>
+class ProxyWrappable final
+    : public cppgc::GarbageCollected<ProxyWrappable<Proxy>> {
+ public:
+  explicit ProxyWrappable(Proxy *proxy) : proxy_(proxy) {}
+  ~ProxyWrappable() {
+    proxy_->ReleaseFromUnifiedHeap();
+  }
+
+  Proxy *Get() const {
+    return proxy_;
+  }
+
+  void Trace(cppgc::Visitor *visitor) const {
+    proxy_->Trace(visitor);
+  }
+
+ private:
+  Proxy *proxy_;
 };
 
 } // namespace rnv8
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "IsolateDisposer.h"
+
+#include <pthread.h>
+
+namespace rnv8 {
+
+// static
+IsolateDisposer &IsolateDisposer::GetInstance() {
+  static IsolateDisposer instance;
+  return instance;
+}
+
+IsolateDisposer::IsolateDisposer() {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+IsolateDisposer::~IsolateDisposer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  queueCondition_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void IsolateDisposer::Dispose(std::shared_ptr<void> object) {
+  if (!object) {
+    return;
+  }
+  bool queued = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopped_ && queue_.size() < kMaxPendingCount) {
+      queue_.push_back(std::move(object));
+      queued = true;
+    }
+  }
+  if (!queued) {
+    // The queue is full, destroy it synchronously
+    object.reset();
+    return;
+  }
+  queueCondition_.notify_one();
+}
+
+void IsolateDisposer::Drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  drainCondition_.wait(lock, [this]() { return queue_.empty() && !running_; });
+}
+
+void IsolateDisposer::Run() {
+#if defined(__APPLE__)
+  pthread_setname_np("rnv8-disposer");
+#elif defined(__ANDROID__)
+  pthread_setname_np(pthread_self(), "rnv8-disposer");
+#endif
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queueCondition_.wait(
+        lock, [this]() { return stopped_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+
+    std::shared_ptr<void> object = std::move(queue_.front());
+    queue_.pop_front();
+    running_ = true;
+    lock.unlock();
+
+    object.reset();
+
+    lock.lock();
+    running_ = false;
+    drainCondition_.notify_all();
+  }
+}
+
+} // namespace rnv8
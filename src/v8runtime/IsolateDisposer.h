@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace rnv8 {
+
+// Tears down isolates of destroyed runtimes on a background thread, so that
+// reloading doesn't block the calling thread while a large heap is freed.
+class IsolateDisposer {
+ public:
+  static IsolateDisposer &GetInstance();
+
+  IsolateDisposer(const IsolateDisposer &) = delete;
+  IsolateDisposer &operator=(const IsolateDisposer &) = delete;
+
+  // Queues the object, whose destructor disposes the isolate, for destruction
+  // on the disposer thread. When the queue is full, the object is destroyed
+  // on the calling thread instead, so pending heaps stay bounded.
+  void Dispose(std::shared_ptr<void> object);
+
+  // Blocks until all queued objects are destroyed.
+  void Drain();
+
+ private:
+  IsolateDisposer();
+  ~IsolateDisposer();
+
+  void Run();
+
+ private:
+  static constexpr size_t kMaxPendingCount = 2;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable queueCondition_;
+  std::condition_variable drainCondition_;
+  std::deque<std::shared_ptr<void>> queue_;
+  bool running_ = false;
+  bool stopped_ = false;
+};
+
+} // namespace rnv8
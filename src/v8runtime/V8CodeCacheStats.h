@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rnv8 {
+
+enum class V8CodeCacheResult {
+  // Code cache disabled, e.g. `CodecacheMode::kNone` or a shared runtime
+  kDisabled,
+  // No code cache file yet
+  kMiss,
+  kHit,
+  // The file was loaded but V8 rejected it, see `V8CodeCacheRejectReason`
+  kRejected,
+  // The script compiled by a previous runtime of a recycled isolate was used
+  kRecycled,
+};
+
+// Why V8 rejected a code cache. Found by comparing the header of the rejected
+// data with the header of the code cache created right after.
+enum class V8CodeCacheRejectReason {
+  kNone,
+  kInvalidHeader,
+  kMagicNumberMismatch,
+  // Produced by another V8 version
+  kVersionMismatch,
+  // Produced for another source, e.g. an updated bundle
+  kSourceMismatch,
+  // Produced with other V8 flags
+  kFlagsMismatch,
+  // The headers match, the payload is corrupted
+  kChecksumMismatch,
+  // No code cache could be created to compare with
+  kUnknown,
+};
+
+// Code cache outcome of one evaluated script
+struct V8CodeCacheRecord {
+  std::string sourceURL;
+  V8CodeCacheResult result = V8CodeCacheResult::kDisabled;
+  V8CodeCacheRejectReason rejectReason = V8CodeCacheRejectReason::kNone;
+  // Size of the loaded code cache file
+  size_t fileSize = 0;
+  // Reading the code cache file
+  double loadMs = 0;
+  // Compiling the script, i.e. deserializing the code cache on hits
+  double compileMs = 0;
+  // Creating and writing a new code cache after a miss or a rejection
+  double saveMs = 0;
+  size_t savedSize = 0;
+};
+
+struct V8CodeCacheStats {
+  static constexpr size_t kMaxRecords = 32;
+
+  uint64_t hitCount = 0;
+  uint64_t missCount = 0;
+  uint64_t rejectedCount = 0;
+  uint64_t recycledCount = 0;
+  // The most recent evaluated scripts, oldest first
+  std::vector<V8CodeCacheRecord> records;
+};
+
+} // namespace rnv8
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8GCTelemetry.h"
+
+#include <algorithm>
+
+namespace rnv8 {
+
+namespace {
+
+// Minor mark-compact and weak callback processing are not tracked
+constexpr v8::GCType kTrackedGCTypes = static_cast<v8::GCType>(
+    v8::kGCTypeScavenge | v8::kGCTypeMarkSweepCompact |
+    v8::kGCTypeIncrementalMarking);
+
+size_t ToIndex(v8::GCType type) {
+  if (type & v8::kGCTypeScavenge) {
+    return static_cast<size_t>(V8GCKind::kScavenge);
+  }
+  if (type & v8::kGCTypeMarkSweepCompact) {
+    return static_cast<size_t>(V8GCKind::kMarkCompact);
+  }
+  return static_cast<size_t>(V8GCKind::kIncrementalMarkingStart);
+}
+
+const char *const kSystraceNames[] = {
+    "V8 GC Scavenge",
+    "V8 GC MarkCompact",
+    "V8 GC IncrementalMarkingStart",
+};
+
+} // namespace
+
+V8GCTelemetry::V8GCTelemetry(v8::Isolate *isolate, bool enableSystrace)
+    : isolate_(isolate),
+      enableSystrace_(enableSystrace),
+      createdTime_(Clock::now()) {
+  isolate_->AddGCPrologueCallback(OnPrologue, this, kTrackedGCTypes);
+  isolate_->AddGCEpilogueCallback(OnEpilogue, this, kTrackedGCTypes);
+}
+
+V8GCTelemetry::~V8GCTelemetry() {
+  isolate_->RemoveGCPrologueCallback(OnPrologue, this);
+  isolate_->RemoveGCEpilogueCallback(OnEpilogue, this);
+}
+
+V8GCStats V8GCTelemetry::GetStats() const {
+  V8GCStats result;
+  result.uptimeMs = std::chrono::duration<double, std::milli>(
+                        Clock::now() - createdTime_)
+                        .count();
+  std::lock_guard<std::mutex> lock(mutex_);
+  result.kinds = stats_;
+  result.recentEvents.reserve(eventCount_);
+  size_t first = (nextEvent_ + kMaxRecentEvents - eventCount_) %
+      kMaxRecentEvents;
+  for (size_t i = 0; i < eventCount_; ++i) {
+    result.recentEvents.push_back(events_[(first + i) % kMaxRecentEvents]);
+  }
+  return result;
+}
+
+// static
+const char *V8GCTelemetry::GetKindName(V8GCKind kind) {
+  switch (kind) {
+    case V8GCKind::kScavenge:
+      return "scavenge";
+    case V8GCKind::kMarkCompact:
+      return "markCompact";
+    case V8GCKind::kIncrementalMarkingStart:
+      return "incrementalMarkingStart";
+    default:
+      return "unknown";
+  }
+}
+
+// static
+void V8GCTelemetry::OnPrologue(
+    v8::Isolate *isolate,
+    v8::GCType type,
+    v8::GCCallbackFlags flags,
+    void *data) {
+  auto *self = static_cast<V8GCTelemetry *>(data);
+  size_t index = ToIndex(type);
+  if (self->enableSystrace_) {
+    self->sections_[index] = std::make_unique<facebook::react::SystraceSection>(
+        kSystraceNames[index]);
+  }
+  self->usedHeapSizesBefore_[index] = self->GetUsedHeapSize();
+  self->startTimes_[index] = Clock::now();
+}
+
+// static
+void V8GCTelemetry::OnEpilogue(
+    v8::Isolate *isolate,
+    v8::GCType type,
+    v8::GCCallbackFlags flags,
+    void *data) {
+  auto *self = static_cast<V8GCTelemetry *>(data);
+  size_t index = ToIndex(type);
+  Clock::time_point now = Clock::now();
+  Clock::time_point start = self->startTimes_[index];
+  V8GCEvent event{
+      static_cast<V8GCKind>(index),
+      std::chrono::duration<double, std::milli>(start - self->createdTime_)
+          .count(),
+      std::chrono::duration<double, std::milli>(now - start).count(),
+      self->usedHeapSizesBefore_[index],
+      self->GetUsedHeapSize()};
+  self->Record(event);
+  self->sections_[index].reset();
+}
+
+size_t V8GCTelemetry::GetUsedHeapSize() {
+  v8::HeapStatistics heapStats;
+  isolate_->GetHeapStatistics(&heapStats);
+  return heapStats.used_heap_size();
+}
+
+void V8GCTelemetry::Record(const V8GCEvent &event) {
+  uint64_t pauseUs = static_cast<uint64_t>(event.pauseMs * 1000);
+  size_t bucket = 0;
+  while (bucket + 1 < V8GCKindStats::kBucketCount &&
+         (pauseUs >> bucket) != 0) {
+    ++bucket;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  V8GCKindStats &stats = stats_[static_cast<size_t>(event.kind)];
+  ++stats.count;
+  stats.totalPauseMs += event.pauseMs;
+  stats.maxPauseMs = std::max(stats.maxPauseMs, event.pauseMs);
+  ++stats.pauseBuckets[bucket];
+
+  events_[nextEvent_] = event;
+  nextEvent_ = (nextEvent_ + 1) % kMaxRecentEvents;
+  eventCount_ = std::min(eventCount_ + 1, kMaxRecentEvents);
+}
+
+} // namespace rnv8
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cxxreact/SystraceSection.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "v8.h"
+
+namespace rnv8 {
+
+enum class V8GCKind {
+  kScavenge,
+  kMarkCompact,
+  // Only the pause starting incremental marking. V8 reports no callbacks
+  // around the marking steps, their time is part of the task running them.
+  kIncrementalMarkingStart,
+  kCount,
+};
+
+struct V8GCEvent {
+  V8GCKind kind;
+  // Since the telemetry was created
+  double startTimeMs;
+  double pauseMs;
+  size_t usedHeapSizeBefore;
+  size_t usedHeapSizeAfter;
+};
+
+struct V8GCKindStats {
+  static constexpr size_t kBucketCount = 24;
+
+  uint64_t count = 0;
+  double totalPauseMs = 0;
+  double maxPauseMs = 0;
+  // Bucket i counts the pauses shorter than 2^i us, and at least 2^(i-1) us.
+  // The last bucket also counts anything longer.
+  std::array<uint64_t, kBucketCount> pauseBuckets{};
+};
+
+struct V8GCStats {
+  double uptimeMs;
+  std::array<V8GCKindStats, static_cast<size_t>(V8GCKind::kCount)> kinds;
+  // The most recent GCs, oldest first
+  std::vector<V8GCEvent> recentEvents;
+};
+
+// Records the pauses of the GCs of an isolate from its GC prologue and
+// epilogue callbacks. The callbacks run on the thread holding the isolate,
+// while the stats can be read from any thread.
+class V8GCTelemetry final {
+ public:
+  V8GCTelemetry(v8::Isolate *isolate, bool enableSystrace);
+  // Must be called with the isolate locked, it removes the GC callbacks
+  ~V8GCTelemetry();
+
+  V8GCTelemetry(const V8GCTelemetry &) = delete;
+  V8GCTelemetry &operator=(const V8GCTelemetry &) = delete;
+
+  V8GCStats GetStats() const;
+
+  static const char *GetKindName(V8GCKind kind);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static void OnPrologue(
+      v8::Isolate *isolate,
+      v8::GCType type,
+      v8::GCCallbackFlags flags,
+      void *data);
+  static void OnEpilogue(
+      v8::Isolate *isolate,
+      v8::GCType type,
+      v8::GCCallbackFlags flags,
+      void *data);
+
+  size_t GetUsedHeapSize();
+  void Record(const V8GCEvent &event);
+
+ private:
+  static constexpr size_t kKindCount = static_cast<size_t>(V8GCKind::kCount);
+  static constexpr size_t kMaxRecentEvents = 64;
+
+  v8::Isolate *isolate_;
+  bool enableSystrace_;
+  Clock::time_point createdTime_;
+
+  // Only accessed in the GC callbacks
+  std::array<Clock::time_point, kKindCount> startTimes_;
+  std::array<size_t, kKindCount> usedHeapSizesBefore_{};
+  std::array<std::unique_ptr<facebook::react::SystraceSection>, kKindCount>
+      sections_;
+
+  mutable std::mutex mutex_; // protects the members below
+  std::array<V8GCKindStats, kKindCount> stats_;
+  std::array<V8GCEvent, kMaxRecentEvents> events_;
+  size_t nextEvent_ = 0;
+  size_t eventCount_ = 0;
+};
+
+} // namespace rnv8
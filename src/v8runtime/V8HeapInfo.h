@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rnv8 {
+
+struct V8HeapSpaceInfo {
+  // e.g. "new_space", "old_space" or "code_space"
+  std::string name;
+  size_t size = 0;
+  size_t used = 0;
+  size_t available = 0;
+  size_t physicalSize = 0;
+};
+
+// Code and metadata sizes, collecting them walks the whole heap
+struct V8HeapCodeInfo {
+  size_t codeAndMetadataSize = 0;
+  size_t bytecodeAndMetadataSize = 0;
+  size_t externalScriptSourceSize = 0;
+  size_t cpuProfilerMetadataSize = 0;
+};
+
+// Heap and engine statistics of a runtime, in bytes unless noted
+struct V8HeapInfo {
+  size_t heapSizeLimit = 0;
+  size_t totalHeapSize = 0;
+  size_t usedHeapSize = 0;
+  size_t totalAvailableSize = 0;
+  size_t totalPhysicalSize = 0;
+  // Memory retained by JS objects outside of the V8 heap, e.g. array buffers
+  size_t externalMemory = 0;
+  size_t mallocedMemory = 0;
+  size_t peakMallocedMemory = 0;
+  size_t globalHandlesSize = 0;
+  size_t usedGlobalHandlesSize = 0;
+  // Number of contexts, detached ones are not yet collected and may be leaks
+  size_t nativeContexts = 0;
+  size_t detachedContexts = 0;
+
+  // Only collected on request
+  std::optional<V8HeapCodeInfo> code;
+
+  std::vector<V8HeapSpaceInfo> spaces;
+
+  // Process wide counts of the jsi values and host objects not yet released
+  size_t livePointerValues = 0;
+  size_t liveHostObjects = 0;
+  size_t liveNativeStates = 0;
+};
+
+} // namespace rnv8
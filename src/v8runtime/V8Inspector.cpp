@@ -9,6 +9,7 @@
 
 #include <regex>
 #include <sstream>
+#include <string_view>
 #include <thread>
 
 #include "folly/dynamic.h"
@@ -20,31 +21,66 @@ namespace rnv8 {
 static const char kInspectorName[] = "React Native V8 Inspector";
 
 namespace {
-std::string ToSTLString(
-    v8::Isolate *isolate,
-    const v8_inspector::StringView &stringView) {
-  int length = static_cast<int>(stringView.length());
-  v8::MaybeLocal<v8::String> v8StringNullable =
-      (stringView.is8Bit()
-           ? v8::String::NewFromOneByte(
-                 isolate,
-                 reinterpret_cast<const uint8_t *>(stringView.characters8()),
-                 v8::NewStringType::kNormal,
-                 length)
-           : v8::String::NewFromTwoByte(
-                 isolate,
-                 reinterpret_cast<const uint16_t *>(stringView.characters16()),
-                 v8::NewStringType::kNormal,
-                 length));
-  if (v8StringNullable.IsEmpty()) {
-    return std::string();
+
+std::mutex s_isolateInspectorsMutex; // protects s_isolateInspectors
+std::unordered_map<v8::Isolate *, std::weak_ptr<IsolateInspector>>
+    s_isolateInspectors;
+
+// Notifications buffered during a dispatch before they are sent anyway, e.g.
+// the chunks of a large heap snapshot
+constexpr size_t kMaxPendingNotifications = 64;
+
+void AppendUtf8(std::string &result, uint32_t codePoint) {
+  if (codePoint < 0x80) {
+    result.push_back(static_cast<char>(codePoint));
+  } else if (codePoint < 0x800) {
+    result.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else if (codePoint < 0x10000) {
+    result.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+    result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else {
+    result.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+    result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    result.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
   }
-  v8::Local<v8::String> v8String = v8StringNullable.ToLocalChecked();
-  v8::String::Utf8Value utf8V8String(isolate, v8String);
-  if (*utf8V8String)
-    return std::string(*utf8V8String, utf8V8String.length());
-  else
-    return std::string();
+}
+
+// Transcodes the Latin-1 or UTF-16 messages of V8 to UTF-8 without going
+// through the isolate. Unpaired surrogates become U+FFFD.
+std::string ToUtf8(const v8_inspector::StringView &stringView) {
+  size_t length = stringView.length();
+  std::string result;
+  if (stringView.is8Bit()) {
+    const uint8_t *chars = stringView.characters8();
+    result.reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+      AppendUtf8(result, chars[i]);
+    }
+    return result;
+  }
+
+  const uint16_t *chars = stringView.characters16();
+  result.reserve(length + length / 2);
+  for (size_t i = 0; i < length; ++i) {
+    uint32_t codeUnit = chars[i];
+    if (codeUnit < 0x80) {
+      result.push_back(static_cast<char>(codeUnit));
+    } else if (codeUnit >= 0xD800 && codeUnit <= 0xDBFF && i + 1 < length &&
+               chars[i + 1] >= 0xDC00 && chars[i + 1] <= 0xDFFF) {
+      AppendUtf8(
+          result,
+          0x10000 + ((codeUnit - 0xD800) << 10) + (chars[i + 1] - 0xDC00));
+      ++i;
+    } else if (codeUnit >= 0xD800 && codeUnit <= 0xDFFF) {
+      AppendUtf8(result, 0xFFFD);
+    } else {
+      AppendUtf8(result, codeUnit);
+    }
+  }
+  return result;
 }
 
 v8_inspector::StringView ToStringView(const std::string &string) {
@@ -52,24 +88,45 @@ v8_inspector::StringView ToStringView(const std::string &string) {
       reinterpret_cast<const uint8_t *>(string.data()), string.size());
 }
 
+// Finds the method of a CDP message without parsing it. DevTools sends the
+// method before the params, which may be large.
+std::string_view GetMethod(std::string_view message) {
+  constexpr std::string_view kMethodKey = "\"method\"";
+  size_t pos = message.find(kMethodKey);
+  if (pos == std::string_view::npos) {
+    return {};
+  }
+  pos = message.find_first_not_of(" \t\r\n:", pos + kMethodKey.size());
+  if (pos == std::string_view::npos || message[pos] != '"') {
+    return {};
+  }
+  size_t end = message.find('"', pos + 1);
+  if (end == std::string_view::npos) {
+    return {};
+  }
+  return message.substr(pos + 1, end - pos - 1);
+}
+
+// Only `Debugger.setBreakpointByUrl` messages with metro's cache prevention
+// query are parsed and rewritten.
 std::string stripMetroCachePrevention(const std::string &message) {
+  if (message.find("cachePrevention") == std::string::npos) {
+    return message;
+  }
+  static const std::regex regex("&?cachePrevention=[0-9]*");
   std::string result;
   try {
     auto messageObj = folly::parseJson(message);
-    auto method = messageObj["method"].asString();
-    if (method == "Debugger.setBreakpointByUrl") {
-      std::regex regex("&?cachePrevention=[0-9]*");
-      auto params = messageObj["params"];
-      auto urlPtr = params.get_ptr("url");
-      if (urlPtr) {
-        messageObj["params"]["url"] =
-            std::regex_replace(urlPtr->asString(), regex, "");
-      }
-      auto urlRegexPtr = params.get_ptr("urlRegex");
-      if (urlRegexPtr) {
-        messageObj["params"]["urlRegex"] =
-            std::regex_replace(urlRegexPtr->asString(), regex, "");
-      }
+    auto params = messageObj["params"];
+    auto urlPtr = params.get_ptr("url");
+    if (urlPtr) {
+      messageObj["params"]["url"] =
+          std::regex_replace(urlPtr->asString(), regex, "");
+    }
+    auto urlRegexPtr = params.get_ptr("urlRegex");
+    if (urlRegexPtr) {
+      messageObj["params"]["urlRegex"] =
+          std::regex_replace(urlRegexPtr->asString(), regex, "");
     }
     result = folly::toJson(messageObj);
   } catch (...) {
@@ -95,7 +152,11 @@ void InspectorFrontend::sendResponse(
 
 void InspectorFrontend::sendNotification(
     std::unique_ptr<v8_inspector::StringBuffer> message) {
-  client_->SendRemoteMessage(message->string());
+  client_->SendRemoteNotification(std::move(message));
+}
+
+void InspectorFrontend::flushProtocolNotifications() {
+  client_->FlushRemoteNotifications();
 }
 
 class LocalConnection : public jsinspector::ILocalConnection {
@@ -129,6 +190,86 @@ class LocalConnection : public jsinspector::ILocalConnection {
   std::weak_ptr<InspectorClient> weakClient_;
 };
 
+// static
+std::shared_ptr<IsolateInspector> IsolateInspector::GetOrCreate(
+    v8::Isolate *isolate) {
+  const std::lock_guard<std::mutex> lock(s_isolateInspectorsMutex);
+  auto &weakInspector = s_isolateInspectors[isolate];
+  auto isolateInspector = weakInspector.lock();
+  if (!isolateInspector) {
+    isolateInspector = std::make_shared<IsolateInspector>(isolate);
+    weakInspector = isolateInspector;
+  }
+  return isolateInspector;
+}
+
+IsolateInspector::IsolateInspector(v8::Isolate *isolate) : isolate_(isolate) {
+  inspector_ = v8_inspector::V8Inspector::create(isolate_, this);
+}
+
+IsolateInspector::~IsolateInspector() {
+  const std::lock_guard<std::mutex> lock(s_isolateInspectorsMutex);
+  auto it = s_isolateInspectors.find(isolate_);
+  if (it != s_isolateInspectors.end() && it->second.expired()) {
+    s_isolateInspectors.erase(it);
+  }
+}
+
+v8_inspector::V8Inspector *IsolateInspector::GetInspector() {
+  return inspector_.get();
+}
+
+void IsolateInspector::AddClient(int contextGroupId, InspectorClient *client) {
+  std::lock_guard<std::mutex> lock(clientsMutex_);
+  clients_[contextGroupId] = client;
+}
+
+void IsolateInspector::RemoveClient(int contextGroupId) {
+  std::lock_guard<std::mutex> lock(clientsMutex_);
+  auto it = clients_.find(contextGroupId);
+  if (it != clients_.end()) {
+    if (pausedClient_ == it->second) {
+      pausedClient_ = nullptr;
+    }
+    clients_.erase(it);
+  }
+}
+
+void IsolateInspector::runMessageLoopOnPause(int contextGroupId) {
+  InspectorClient *client = GetClient(contextGroupId);
+  if (!client) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    pausedClient_ = client;
+  }
+  client->RunMessageLoopOnPause();
+}
+
+void IsolateInspector::quitMessageLoopOnPause() {
+  std::lock_guard<std::mutex> lock(clientsMutex_);
+  if (pausedClient_) {
+    pausedClient_->QuitMessageLoopOnPause();
+    pausedClient_ = nullptr;
+  }
+}
+
+v8::Local<v8::Context> IsolateInspector::ensureDefaultContextInGroup(
+    int contextGroupId) {
+  InspectorClient *client = GetClient(contextGroupId);
+  if (!client) {
+    return {};
+  }
+  return client->GetContext().Get(isolate_);
+}
+
+InspectorClient *IsolateInspector::GetClient(int contextGroupId) {
+  std::lock_guard<std::mutex> lock(clientsMutex_);
+  auto it = clients_.find(contextGroupId);
+  return it != clients_.end() ? it->second : nullptr;
+}
+
 int InspectorClient::nextContextGroupId_ = 1;
 
 InspectorClient::InspectorClient(
@@ -140,33 +281,57 @@ InspectorClient::InspectorClient(
   isolate_ = context->GetIsolate();
   v8::HandleScope scopedHandle(isolate_);
   channel_.reset(new InspectorFrontend(this, context));
-  inspector_ = v8_inspector::V8Inspector::create(isolate_, this);
+  isolateInspector_ = IsolateInspector::GetOrCreate(isolate_);
   inspectorName_ = CreateInspectorName(appName, deviceName);
-  v8_inspector::StringView inspectorNameStringView =
-      ToStringView(inspectorName_);
-  int contextGroupId = nextContextGroupId_++;
-  session_ = inspector_->connect(
-      contextGroupId,
-      channel_.get(),
-#if V8_MAJOR_VERSION >= 11
-      inspectorNameStringView,
-      v8_inspector::V8Inspector::kFullyTrusted);
-#else
-      inspectorNameStringView);
-#endif
+  contextGroupId_ = nextContextGroupId_++;
   context_.Reset(isolate_, context);
+  isolateInspector_->AddClient(contextGroupId_, this);
 
-  inspector_->contextCreated(v8_inspector::V8ContextInfo(
-      context, contextGroupId, inspectorNameStringView));
+  // Registered up front, scripts are only reported to a later session when
+  // they were compiled in a context known to the inspector. The debugger
+  // stays off until a session enables it.
+  isolateInspector_->GetInspector()->contextCreated(v8_inspector::V8ContextInfo(
+      context, contextGroupId_, ToStringView(inspectorName_)));
 }
 
 InspectorClient::~InspectorClient() {
   v8::HandleScope scopedHandle(isolate_);
-  inspector_->contextDestroyed(context_.Get(isolate_));
+  isolateInspector_->GetInspector()->contextDestroyed(context_.Get(isolate_));
   Disconnect();
+  session_.reset();
+  isolateInspector_->RemoveClient(contextGroupId_);
+}
+
+void InspectorClient::AttachInspectorSession() {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+  if (session_) {
+    return;
+  }
+  v8::Context::Scope scopedContext(context_.Get(isolate_));
+  session_ = isolateInspector_->GetInspector()->connect(
+      contextGroupId_,
+      channel_.get(),
+#if V8_MAJOR_VERSION >= 11
+      ToStringView(inspectorName_),
+      v8_inspector::V8Inspector::kFullyTrusted);
+#else
+      ToStringView(inspectorName_));
+#endif
 }
 
-void InspectorClient::runMessageLoopOnPause(int contextGroupId) {
+void InspectorClient::DetachInspectorSession() {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  // The context stays registered, so its scripts are reported again to the
+  // next session
+  session_.reset();
+}
+
+void InspectorClient::RunMessageLoopOnPause() {
+  // e.g. `Debugger.paused`, before blocking the JS thread
+  FlushRemoteNotifications();
   paused_ = true;
   while (paused_) {
     std::unique_lock<std::mutex> lock(pauseMutex_);
@@ -177,16 +342,11 @@ void InspectorClient::runMessageLoopOnPause(int contextGroupId) {
   }
 }
 
-void InspectorClient::quitMessageLoopOnPause() {
+void InspectorClient::QuitMessageLoopOnPause() {
   paused_ = false;
   pauseWaitable_.notify_all();
 }
 
-v8::Local<v8::Context> InspectorClient::ensureDefaultContextInGroup(
-    int group_id) {
-  return context_.Get(isolate_);
-}
-
 void InspectorClient::ConnectToReactFrontend() {
   std::lock_guard<std::mutex> lock(connectionMutex_);
 
@@ -199,6 +359,7 @@ void InspectorClient::ConnectToReactFrontend() {
         auto client = weakClient.lock();
         if (client) {
           client->remoteConn_ = std::move(remoteConn);
+          client->AttachInspectorSession();
         }
         return std::make_unique<LocalConnection>(weakClient);
       });
@@ -219,19 +380,43 @@ void InspectorClient::DisconnectFromReactFrontend() {
            folly::dynamic::object("method", "Debugger.disable")("id", 1e9)),
        folly::toJson(
            folly::dynamic::object("method", "Runtime.disable")("id", 1e9))});
+  DetachInspectorSession();
 }
 
 void InspectorClient::SendRemoteMessage(
     const v8_inspector::StringView &message) {
+  // Keeps the notifications of a command before its response
+  FlushRemoteNotifications();
   if (remoteConn_) {
-    v8::Isolate *isolate = GetIsolate();
-    v8::Locker locker(isolate);
-    v8::Isolate::Scope scopedIsolate(isolate);
-    v8::HandleScope scopedHandle(isolate);
-    v8::Context::Scope scopedContext(GetContext().Get(isolate));
-
-    std::string messageString = ToSTLString(isolate_, message);
-    remoteConn_->onMessage(messageString);
+    remoteConn_->onMessage(ToUtf8(message));
+  }
+}
+
+void InspectorClient::SendRemoteNotification(
+    std::unique_ptr<v8_inspector::StringBuffer> message) {
+  if (dispatchDepth_ == 0) {
+    if (remoteConn_) {
+      remoteConn_->onMessage(ToUtf8(message->string()));
+    }
+    return;
+  }
+  pendingNotifications_.push_back(std::move(message));
+  if (pendingNotifications_.size() >= kMaxPendingNotifications) {
+    FlushRemoteNotifications();
+  }
+}
+
+void InspectorClient::FlushRemoteNotifications() {
+  if (pendingNotifications_.empty()) {
+    return;
+  }
+  std::vector<std::unique_ptr<v8_inspector::StringBuffer>> notifications;
+  notifications.swap(pendingNotifications_);
+  if (!remoteConn_) {
+    return;
+  }
+  for (const auto &notification : notifications) {
+    remoteConn_->onMessage(ToUtf8(notification->string()));
   }
 }
 
@@ -246,35 +431,47 @@ void InspectorClient::AwakePauseLockWithMessage(const std::string &message) {
 }
 
 void InspectorClient::DispatchProxy(const std::string &message) {
-  std::string normalizedString = stripMetroCachePrevention(message);
-
-  auto messageObj = folly::parseJson(message);
-  auto method = messageObj["method"].asString();
+  std::string_view method = GetMethod(message);
+  if (method == "Debugger.setBreakpointByUrl") {
+    DispatchToSession(stripMetroCachePrevention(message));
+    return;
+  }
 
   // For `v8::CpuProfiler` or some other modules with thread local storage, we
   // should dispatch messages in the js thread.
   if (method == "Profiler.start" || method == "Profiler.stop") {
-    jsQueue_->runOnQueue([this, normalizedString]() {
+    jsQueue_->runOnQueue([this, message]() {
       v8::Isolate *isolate = GetIsolate();
       v8::Locker locker(isolate);
       v8::Isolate::Scope scopedIsolate(isolate);
       v8::HandleScope scopedHandle(isolate);
       v8::Context::Scope scopedContext(GetContext().Get(isolate));
-      session_->dispatchProtocolMessage(ToStringView(normalizedString));
+      // The debugger may have detached in the meantime
+      if (session_) {
+        DispatchToSession(message);
+      }
     });
     return;
   }
 
-  session_->dispatchProtocolMessage(ToStringView(normalizedString));
+  DispatchToSession(message);
+}
+
+void InspectorClient::DispatchToSession(const std::string &message) {
+  // Notifications of the command are batched until it returns
+  ++dispatchDepth_;
+  session_->dispatchProtocolMessage(ToStringView(message));
+  --dispatchDepth_;
+  FlushRemoteNotifications();
 }
 
 void InspectorClient::DispatchProtocolMessage(const std::string &message) {
-  auto session = GetInspectorSession();
-  if (!session) {
-    return;
-  }
   v8::Isolate *isolate = GetIsolate();
   v8::Locker locker(isolate);
+  // Attaching and detaching the session also take the locker
+  if (!GetInspectorSession()) {
+    return;
+  }
   v8::Isolate::Scope scopedIsolate(isolate);
   v8::HandleScope scopedHandle(isolate);
   v8::Context::Scope scopedContext(GetContext().Get(isolate));
@@ -283,12 +480,11 @@ void InspectorClient::DispatchProtocolMessage(const std::string &message) {
 
 void InspectorClient::DispatchProtocolMessages(
     const std::vector<std::string> &messages) {
-  auto session = GetInspectorSession();
-  if (!session) {
-    return;
-  }
   v8::Isolate *isolate = GetIsolate();
   v8::Locker locker(isolate);
+  if (!GetInspectorSession()) {
+    return;
+  }
   v8::Isolate::Scope scopedIsolate(isolate);
   v8::HandleScope scopedHandle(isolate);
   v8::Context::Scope scopedContext(GetContext().Get(isolate));
@@ -9,6 +9,9 @@
 
 #include <cxxreact/MessageQueueThread.h>
 #include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "v8-inspector.h"
 
 #if REACT_NATIVE_MINOR_VERSION >= 73
@@ -43,7 +46,7 @@ class InspectorFrontend final : public v8_inspector::V8Inspector::Channel {
       std::unique_ptr<v8_inspector::StringBuffer> message) override;
   void sendNotification(
       std::unique_ptr<v8_inspector::StringBuffer> message) override;
-  void flushProtocolNotifications() override {}
+  void flushProtocolNotifications() override;
 
  private:
   InspectorClient *client_;
@@ -51,25 +54,61 @@ class InspectorFrontend final : public v8_inspector::V8Inspector::Channel {
   v8::Global<v8::Context> context_;
 };
 
+// Owns the V8Inspector of an isolate. V8 supports only one inspector per
+// isolate, so the InspectorClient of every context in a shared isolate
+// connects through the same instance with its own context group.
+class IsolateInspector final : public v8_inspector::V8InspectorClient {
+ public:
+  static std::shared_ptr<IsolateInspector> GetOrCreate(v8::Isolate *isolate);
+
+  explicit IsolateInspector(v8::Isolate *isolate);
+  ~IsolateInspector() override;
+
+  v8_inspector::V8Inspector *GetInspector();
+  void AddClient(int contextGroupId, InspectorClient *client);
+  void RemoveClient(int contextGroupId);
+
+  void runMessageLoopOnPause(int contextGroupId) override;
+  void quitMessageLoopOnPause() override;
+  v8::Local<v8::Context> ensureDefaultContextInGroup(
+      int contextGroupId) override;
+
+ private:
+  InspectorClient *GetClient(int contextGroupId);
+
+ private:
+  v8::Isolate *isolate_;
+  std::unique_ptr<v8_inspector::V8Inspector> inspector_;
+  std::mutex clientsMutex_;
+  std::unordered_map<int, InspectorClient *> clients_;
+  InspectorClient *pausedClient_ = nullptr;
+};
+
 class InspectorClient final
-    : public v8_inspector::V8InspectorClient,
-      public std::enable_shared_from_this<InspectorClient> {
+    : public std::enable_shared_from_this<InspectorClient> {
  public:
   InspectorClient(
       std::shared_ptr<facebook::react::MessageQueueThread> jsQueue,
       v8::Local<v8::Context> context,
       const std::string &appName,
       const std::string &deviceName);
-  ~InspectorClient() override;
+  ~InspectorClient();
 
-  void runMessageLoopOnPause(int contextGroupId) override;
-  void quitMessageLoopOnPause() override;
-  v8::Local<v8::Context> ensureDefaultContextInGroup(int group_id) override;
+  void RunMessageLoopOnPause();
+  void QuitMessageLoopOnPause();
 
+  // Registers the page with the React Native inspector. The session is only
+  // connected while a debugger is attached, so the debugger instrumentation
+  // is off in between.
   void ConnectToReactFrontend();
+  void AttachInspectorSession();
+  void DetachInspectorSession();
   void Disconnect();
   void DisconnectFromReactFrontend();
   void SendRemoteMessage(const v8_inspector::StringView &message);
+  void SendRemoteNotification(
+      std::unique_ptr<v8_inspector::StringBuffer> message);
+  void FlushRemoteNotifications();
   bool IsPaused();
   void AwakePauseLockWithMessage(const std::string &message);
   void DispatchProxy(const std::string &message);
@@ -88,10 +127,13 @@ class InspectorClient final
 
   std::weak_ptr<InspectorClient> CreateWeakPtr();
 
+  void DispatchToSession(const std::string &message);
+
  private:
   static int nextContextGroupId_;
 
-  std::unique_ptr<v8_inspector::V8Inspector> inspector_;
+  std::shared_ptr<IsolateInspector> isolateInspector_;
+  int contextGroupId_;
   std::unique_ptr<v8_inspector::V8InspectorSession> session_;
   std::unique_ptr<v8_inspector::V8Inspector::Channel> channel_;
   v8::Isolate *isolate_;
@@ -106,6 +148,11 @@ class InspectorClient final
   bool paused_ = false;
   std::vector<std::string> protocolMessageQueue_;
 
+  // Accessed under the v8::Locker
+  int dispatchDepth_ = 0;
+  std::vector<std::unique_ptr<v8_inspector::StringBuffer>>
+      pendingNotifications_;
+
   int pageId_;
   std::shared_ptr<ClientConnectionWrapper> clientConnectionWrapper_;
 };
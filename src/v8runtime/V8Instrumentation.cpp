@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8Instrumentation.h"
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace rnv8 {
+
+namespace {
+
+constexpr size_t kOperationCount = static_cast<size_t>(JSIOperation::kCount);
+
+const char *const kOperationNames[] = {
+    "evaluateJavaScript",
+    "getProperty",
+    "hasProperty",
+    "setPropertyValue",
+    "getValueAtIndex",
+    "setValueAtIndex",
+    "call",
+    "callAsConstructor",
+    "createObject",
+    "createStringFromAscii",
+    "createStringFromUtf8",
+    "createPropNameIDFromAscii",
+    "createPropNameIDFromUtf8",
+    "createFunctionFromHostFunction",
+    "utf8",
+};
+static_assert(
+    sizeof(kOperationNames) / sizeof(kOperationNames[0]) == kOperationCount,
+    "kOperationNames must match JSIOperation");
+
+} // namespace
+
+struct V8Instrumentation::Histogram {
+  // Only the owner thread writes, the relaxed atomics are for the snapshots
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> totalNs{0};
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+
+  void Record(uint64_t ns) {
+    size_t bucket = 0;
+    while (bucket + 1 < kBucketCount && (ns >> bucket) != 0) {
+      ++bucket;
+    }
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNs.fetch_add(ns, std::memory_order_relaxed);
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Clear() {
+    count.store(0, std::memory_order_relaxed);
+    totalNs.store(0, std::memory_order_relaxed);
+    for (auto &bucket : buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void MergeInto(JSIHistogram &result) const {
+    result.count += count.load(std::memory_order_relaxed);
+    result.totalNs += totalNs.load(std::memory_order_relaxed);
+    result.buckets.resize(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      result.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+};
+
+struct V8Instrumentation::ThreadCounters {
+  std::array<Histogram, kOperationCount> operations;
+
+  // The owner thread looks up without the lock, as it is the only writer
+  std::mutex namedMutex; // protects insertions to `named`
+  std::unordered_map<std::string, std::unique_ptr<Histogram>> named;
+};
+
+struct V8Instrumentation::Registry {
+  std::mutex mutex; // protects `threads`
+  // Counters of exited threads are kept to stay in the snapshots
+  std::vector<std::shared_ptr<ThreadCounters>> threads;
+};
+
+// static
+std::vector<JSIHistogram> V8Instrumentation::Snapshot() {
+  std::vector<JSIHistogram> operations(kOperationCount);
+  std::map<std::string, JSIHistogram> named;
+
+  Registry &registry = GetRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto &thread : registry.threads) {
+      for (size_t i = 0; i < kOperationCount; ++i) {
+        thread->operations[i].MergeInto(operations[i]);
+      }
+      std::lock_guard<std::mutex> namedLock(thread->namedMutex);
+      for (const auto &[name, histogram] : thread->named) {
+        histogram->MergeInto(named[name]);
+      }
+    }
+  }
+
+  std::vector<JSIHistogram> result;
+  for (size_t i = 0; i < kOperationCount; ++i) {
+    if (operations[i].count > 0) {
+      operations[i].name = kOperationNames[i];
+      result.push_back(std::move(operations[i]));
+    }
+  }
+  for (auto &[name, histogram] : named) {
+    if (histogram.count > 0) {
+      histogram.name = name;
+      result.push_back(std::move(histogram));
+    }
+  }
+  return result;
+}
+
+// static
+void V8Instrumentation::Reset() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto &thread : registry.threads) {
+    for (auto &histogram : thread->operations) {
+      histogram.Clear();
+    }
+    std::lock_guard<std::mutex> namedLock(thread->namedMutex);
+    for (auto &[name, histogram] : thread->named) {
+      histogram->Clear();
+    }
+  }
+}
+
+// static
+V8Instrumentation::Registry &V8Instrumentation::GetRegistry() {
+  // Leaked to outlive the threads exiting during static destruction
+  static Registry *registry = new Registry();
+  return *registry;
+}
+
+// static
+V8Instrumentation::ThreadCounters &V8Instrumentation::GetThreadCounters() {
+  thread_local std::shared_ptr<ThreadCounters> counters;
+  if (!counters) {
+    counters = std::make_shared<ThreadCounters>();
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(counters);
+  }
+  return *counters;
+}
+
+// static
+V8Instrumentation::Histogram *V8Instrumentation::GetHistogram(
+    const std::string &name) {
+  ThreadCounters &counters = GetThreadCounters();
+  auto it = counters.named.find(name);
+  if (it != counters.named.end()) {
+    return it->second.get();
+  }
+  std::lock_guard<std::mutex> lock(counters.namedMutex);
+  return counters.named.emplace(name, std::make_unique<Histogram>())
+      .first->second.get();
+}
+
+V8Instrumentation::Scope::Scope(JSIOperation operation)
+    : histogram_(
+          &GetThreadCounters().operations[static_cast<size_t>(operation)]),
+      start_(std::chrono::steady_clock::now()) {}
+
+V8Instrumentation::Scope::Scope(const std::string &name)
+    : histogram_(GetHistogram(name)),
+      start_(std::chrono::steady_clock::now()) {}
+
+V8Instrumentation::Scope::~Scope() {
+  auto elapsed = std::chrono::steady_clock::now() - start_;
+  histogram_->Record(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+} // namespace rnv8
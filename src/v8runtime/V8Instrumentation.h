@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Build with -DRNV8_ENABLE_INSTRUMENTATION=1 to record the JSI calls.
+// Otherwise the `RNV8_INSTRUMENT_*` macros expand to nothing.
+#ifndef RNV8_ENABLE_INSTRUMENTATION
+#define RNV8_ENABLE_INSTRUMENTATION 0
+#endif
+
+#if RNV8_ENABLE_INSTRUMENTATION
+#define RNV8_INSTRUMENT_JSI(operation)                      \
+  rnv8::V8Instrumentation::Scope rnv8InstrumentationScope_( \
+      rnv8::JSIOperation::operation)
+#define RNV8_INSTRUMENT_NAMED(name) \
+  rnv8::V8Instrumentation::Scope rnv8InstrumentationScope_(name)
+#else
+#define RNV8_INSTRUMENT_JSI(operation)
+#define RNV8_INSTRUMENT_NAMED(name)
+#endif
+
+namespace rnv8 {
+
+// The instrumented JSI entry points of V8Runtime
+enum class JSIOperation {
+  kEvaluateJavaScript,
+  kGetProperty,
+  kHasProperty,
+  kSetPropertyValue,
+  kGetValueAtIndex,
+  kSetValueAtIndex,
+  kCall,
+  kCallAsConstructor,
+  kCreateObject,
+  kCreateStringFromAscii,
+  kCreateStringFromUtf8,
+  kCreatePropNameIDFromAscii,
+  kCreatePropNameIDFromUtf8,
+  kCreateFunctionFromHostFunction,
+  kUtf8,
+  kCount,
+};
+
+// Calls and latencies of one JSI operation or host callback, summed over all
+// threads. Latencies include nested calls, e.g. the host functions called
+// from `call()`.
+struct JSIHistogram {
+  std::string name;
+  uint64_t count;
+  uint64_t totalNs;
+  // Bucket i counts the calls that took less than 2^i ns, and at least
+  // 2^(i-1) ns. The last bucket also counts anything slower.
+  std::vector<uint64_t> buckets;
+};
+
+// Process wide call counters and latency histograms for the JSI entry points.
+// Each thread records into its own relaxed atomic counters, so recording never
+// contends on a lock.
+class V8Instrumentation final {
+ public:
+  static constexpr size_t kBucketCount = 32;
+
+  V8Instrumentation() = delete;
+
+  static constexpr bool IsEnabled() {
+    return RNV8_ENABLE_INSTRUMENTATION;
+  }
+
+  // Returns the histograms with at least one call, operations first and then
+  // host callbacks sorted by name.
+  static std::vector<JSIHistogram> Snapshot();
+
+  // Clears all the counters. Calls in flight may still be recorded.
+  static void Reset();
+
+ private:
+  struct Histogram;
+  struct ThreadCounters;
+  struct Registry;
+
+  static Registry &GetRegistry();
+  static ThreadCounters &GetThreadCounters();
+  static Histogram *GetHistogram(const std::string &name);
+
+ public:
+  // Records the latency of the enclosing block
+  class Scope final {
+   public:
+    explicit Scope(JSIOperation operation);
+    // For host callbacks, e.g. "HostFunction:nativeCallSyncHook"
+    explicit Scope(const std::string &name);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    Histogram *histogram_;
+    std::chrono::steady_clock::time_point start_;
+  };
+};
+
+} // namespace rnv8
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8MessageChannel.h"
+
+#include <glog/logging.h>
+#include "JSIV8ValueConverter.h"
+#include "V8Runtime.h"
+
+namespace jsi = facebook::jsi;
+
+namespace rnv8 {
+
+namespace {
+
+class SerializerDelegate final : public v8::ValueSerializer::Delegate {
+ public:
+  SerializerDelegate(
+      v8::Isolate *isolate,
+      V8MessageChannel::SerializedMessage &message)
+      : isolate_(isolate), message_(message) {}
+
+  void ThrowDataCloneError(v8::Local<v8::String> message) override {
+    isolate_->ThrowException(v8::Exception::Error(message));
+  }
+
+  v8::Maybe<uint32_t> GetSharedArrayBufferId(
+      v8::Isolate *isolate,
+      v8::Local<v8::SharedArrayBuffer> sharedArrayBuffer) override {
+    std::shared_ptr<v8::BackingStore> backingStore =
+        sharedArrayBuffer->GetBackingStore();
+    auto &sharedArrayBuffers = message_.sharedArrayBuffers;
+    for (size_t i = 0; i < sharedArrayBuffers.size(); ++i) {
+      if (sharedArrayBuffers[i] == backingStore) {
+        return v8::Just(static_cast<uint32_t>(i));
+      }
+    }
+    sharedArrayBuffers.push_back(std::move(backingStore));
+    return v8::Just(static_cast<uint32_t>(sharedArrayBuffers.size() - 1));
+  }
+
+ private:
+  v8::Isolate *isolate_;
+  V8MessageChannel::SerializedMessage &message_;
+};
+
+class DeserializerDelegate final : public v8::ValueDeserializer::Delegate {
+ public:
+  explicit DeserializerDelegate(V8MessageChannel::SerializedMessage &message)
+      : message_(message) {}
+
+  v8::MaybeLocal<v8::SharedArrayBuffer> GetSharedArrayBufferFromId(
+      v8::Isolate *isolate,
+      uint32_t id) override {
+    if (id >= message_.sharedArrayBuffers.size()) {
+      return {};
+    }
+    return v8::SharedArrayBuffer::New(
+        isolate, message_.sharedArrayBuffers[id]);
+  }
+
+ private:
+  V8MessageChannel::SerializedMessage &message_;
+};
+
+} // namespace
+
+// static
+std::shared_ptr<V8MessageChannel> V8MessageChannel::Create(
+    V8Runtime &runtime1,
+    const std::string &portName1,
+    V8Runtime &runtime2,
+    const std::string &portName2) {
+  auto channel = std::make_shared<V8MessageChannel>(
+      runtime1, portName1, runtime2, portName2);
+  channel->InstallPort(0, runtime1);
+  channel->InstallPort(1, runtime2);
+  return channel;
+}
+
+V8MessageChannel::V8MessageChannel(
+    V8Runtime &runtime1,
+    const std::string &portName1,
+    V8Runtime &runtime2,
+    const std::string &portName2)
+    : runtimeRefs_{runtime1.selfRef_, runtime2.selfRef_},
+      jsQueues_{runtime1.jsQueue_, runtime2.jsQueue_},
+      portNames_{portName1, portName2} {}
+
+void V8MessageChannel::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+}
+
+bool V8MessageChannel::IsClosed() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return closed_;
+}
+
+// static
+std::unique_ptr<V8MessageChannel::SerializedMessage>
+V8MessageChannel::Serialize(
+    v8::Isolate *isolate,
+    v8::Local<v8::Context> context,
+    v8::Local<v8::Value> value,
+    v8::Local<v8::Value> transferList) {
+  auto message = std::make_unique<SerializedMessage>();
+  SerializerDelegate delegate(isolate, *message);
+  v8::ValueSerializer serializer(isolate, &delegate);
+
+  std::vector<v8::Local<v8::ArrayBuffer>> arrayBuffers;
+  if (transferList->IsArray()) {
+    v8::Local<v8::Array> array = transferList.As<v8::Array>();
+    for (uint32_t i = 0; i < array->Length(); ++i) {
+      v8::Local<v8::Value> item;
+      if (!array->Get(context, i).ToLocal(&item)) {
+        return nullptr;
+      }
+      if (!item->IsArrayBuffer() ||
+          !item.As<v8::ArrayBuffer>()->IsDetachable()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8Literal(
+                isolate, "Only detachable ArrayBuffers can be transferred")));
+        return nullptr;
+      }
+      v8::Local<v8::ArrayBuffer> arrayBuffer = item.As<v8::ArrayBuffer>();
+      serializer.TransferArrayBuffer(
+          static_cast<uint32_t>(arrayBuffers.size()), arrayBuffer);
+      arrayBuffers.push_back(arrayBuffer);
+    }
+  } else if (!transferList->IsNullOrUndefined()) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8Literal(
+            isolate, "The transfer list must be an array")));
+    return nullptr;
+  }
+
+  serializer.WriteHeader();
+  if (serializer.WriteValue(context, value).IsNothing()) {
+    return nullptr;
+  }
+
+  // Move the backing stores to the receiver, the sender's buffers become
+  // detached.
+  for (auto &arrayBuffer : arrayBuffers) {
+    message->arrayBuffers.push_back(arrayBuffer->GetBackingStore());
+#if V8_MAJOR_VERSION >= 11
+    arrayBuffer->Detach(v8::Local<v8::Value>()).Check();
+#else
+    arrayBuffer->Detach();
+#endif
+  }
+
+  std::pair<uint8_t *, size_t> buffer = serializer.Release();
+  message->data.reset(buffer.first);
+  message->size = buffer.second;
+  return message;
+}
+
+// static
+v8::MaybeLocal<v8::Value> V8MessageChannel::Deserialize(
+    v8::Isolate *isolate,
+    v8::Local<v8::Context> context,
+    SerializedMessage &message) {
+  DeserializerDelegate delegate(message);
+  v8::ValueDeserializer deserializer(
+      isolate, message.data.get(), message.size, &delegate);
+  if (deserializer.ReadHeader(context).IsNothing()) {
+    return {};
+  }
+  for (size_t i = 0; i < message.arrayBuffers.size(); ++i) {
+    deserializer.TransferArrayBuffer(
+        static_cast<uint32_t>(i),
+        v8::ArrayBuffer::New(isolate, std::move(message.arrayBuffers[i])));
+  }
+  message.arrayBuffers.clear();
+  return deserializer.ReadValue(context);
+}
+
+void V8MessageChannel::InstallPort(size_t index, V8Runtime &runtime) {
+  jsi::Object port(runtime);
+
+  auto self = shared_from_this();
+  port.setProperty(
+      runtime,
+      "postMessage",
+      jsi::Function::createFromHostFunction(
+          runtime,
+          jsi::PropNameID::forAscii(runtime, "postMessage"),
+          2,
+          [self, index](
+              jsi::Runtime &runtime,
+              const jsi::Value &thisValue,
+              const jsi::Value *args,
+              size_t count) {
+            return self->PostMessage(
+                index, static_cast<V8Runtime &>(runtime), args, count);
+          }));
+  port.setProperty(
+      runtime,
+      "close",
+      jsi::Function::createFromHostFunction(
+          runtime,
+          jsi::PropNameID::forAscii(runtime, "close"),
+          0,
+          [self](
+              jsi::Runtime &runtime,
+              const jsi::Value &thisValue,
+              const jsi::Value *args,
+              size_t count) {
+            self->Close();
+            return jsi::Value::undefined();
+          }));
+  port.setProperty(runtime, "onmessage", jsi::Value::null());
+
+  runtime.global().setProperty(runtime, portNames_[index].c_str(), port);
+}
+
+jsi::Value V8MessageChannel::PostMessage(
+    size_t fromIndex,
+    V8Runtime &runtime,
+    const jsi::Value *args,
+    size_t count) {
+  if (IsClosed()) {
+    throw jsi::JSError(runtime, "The message channel is closed");
+  }
+
+  v8::Isolate *isolate = runtime.isolate_;
+  v8::HandleScope scopedHandle(isolate);
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Value> value = count > 0
+      ? JSIV8ValueConverter::ToV8Value(runtime, args[0])
+      : v8::Undefined(isolate).As<v8::Value>();
+  v8::Local<v8::Value> transferList = count > 1
+      ? JSIV8ValueConverter::ToV8Value(runtime, args[1])
+      : v8::Undefined(isolate).As<v8::Value>();
+
+  v8::TryCatch tryCatch(isolate);
+  std::shared_ptr<SerializedMessage> message =
+      Serialize(isolate, context, value, transferList);
+  if (!message) {
+    std::string error = tryCatch.HasCaught()
+        ? JSIV8ValueConverter::ToSTLString(isolate, tryCatch.Exception())
+        : "Unable to serialize the message";
+    throw jsi::JSError(runtime, error);
+  }
+
+  size_t toIndex = 1 - fromIndex;
+  if (runtimeRefs_[toIndex].expired()) {
+    // The receiving runtime is gone, drop the message
+    return jsi::Value::undefined();
+  }
+  std::shared_ptr<facebook::react::MessageQueueThread> jsQueue =
+      jsQueues_[toIndex];
+  if (!jsQueue) {
+    throw jsi::JSError(runtime, "The receiving runtime has no JS queue");
+  }
+  jsQueue->runOnQueue(
+      [weakThis = weak_from_this(), toIndex, message = std::move(message)]() {
+        if (auto self = weakThis.lock()) {
+          self->DispatchMessage(toIndex, *message);
+        }
+      });
+  return jsi::Value::undefined();
+}
+
+void V8MessageChannel::DispatchMessage(
+    size_t toIndex,
+    SerializedMessage &message) {
+  if (IsClosed()) {
+    return;
+  }
+  // Runtimes are destroyed on their JS thread, so the runtime stays alive
+  // while the message is dispatched
+  std::shared_ptr<V8Runtime *> runtimeRef = runtimeRefs_[toIndex].lock();
+  if (!runtimeRef) {
+    return;
+  }
+
+  V8Runtime &runtime = **runtimeRef;
+  try {
+    jsi::Value port =
+        runtime.global().getProperty(runtime, portNames_[toIndex].c_str());
+    if (!port.isObject()) {
+      return;
+    }
+    jsi::Value onmessage =
+        port.getObject(runtime).getProperty(runtime, "onmessage");
+    if (!onmessage.isObject() ||
+        !onmessage.getObject(runtime).isFunction(runtime)) {
+      return;
+    }
+
+    jsi::Value data;
+    {
+      v8::Isolate *isolate = runtime.isolate_;
+      v8::Locker locker(isolate);
+      v8::Isolate::Scope scopedIsolate(isolate);
+      v8::HandleScope scopedHandle(isolate);
+      v8::Local<v8::Context> context = runtime.context_.Get(isolate);
+      v8::Context::Scope scopedContext(context);
+
+      v8::TryCatch tryCatch(isolate);
+      v8::Local<v8::Value> value;
+      if (!Deserialize(isolate, context, message).ToLocal(&value)) {
+        LOG(ERROR) << "[rnv8] Unable to deserialize the message";
+        return;
+      }
+      data = JSIV8ValueConverter::ToJSIValue(isolate, value);
+    }
+
+    jsi::Object event(runtime);
+    event.setProperty(runtime, "data", data);
+    onmessage.getObject(runtime).getFunction(runtime).callWithThis(
+        runtime, port.getObject(runtime), event);
+  } catch (const jsi::JSError &error) {
+    LOG(ERROR) << "[rnv8] Uncaught error in onmessage: " << error.what();
+  } catch (const std::exception &ex) {
+    LOG(ERROR) << "[rnv8] Unable to dispatch the message: " << ex.what();
+  }
+}
+
+} // namespace rnv8
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cxxreact/MessageQueueThread.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "jsi/jsi.h"
+#include "v8.h"
+
+namespace rnv8 {
+
+class V8Runtime;
+
+// A message channel between two runtimes built on v8::ValueSerializer.
+// ArrayBuffers in the transfer list are moved to the receiver without copying
+// their contents, and SharedArrayBuffers share their backing store.
+//
+// Each runtime gets a port object as a global:
+//   port.postMessage(value, [arrayBuffer, ...]);
+//   port.onmessage = (event) => { event.data };
+//   port.close();
+//
+// Messages are delivered on the receiving runtime's JS queue, so a worker
+// runtime should be created with its own queue and both runtimes need their
+// queue when the channel is created. Messages to a destroyed runtime are
+// dropped.
+class V8MessageChannel final
+    : public std::enable_shared_from_this<V8MessageChannel> {
+ public:
+  static std::shared_ptr<V8MessageChannel> Create(
+      V8Runtime &runtime1,
+      const std::string &portName1,
+      V8Runtime &runtime2,
+      const std::string &portName2);
+
+  V8MessageChannel(
+      V8Runtime &runtime1,
+      const std::string &portName1,
+      V8Runtime &runtime2,
+      const std::string &portName2);
+
+  V8MessageChannel(const V8MessageChannel &) = delete;
+  V8MessageChannel &operator=(const V8MessageChannel &) = delete;
+
+  // Stops delivering messages in both directions
+  void Close();
+  bool IsClosed();
+
+  struct SerializedMessage {
+    std::unique_ptr<uint8_t, void (*)(void *)> data{nullptr, &free};
+    size_t size = 0;
+    std::vector<std::shared_ptr<v8::BackingStore>> arrayBuffers;
+    std::vector<std::shared_ptr<v8::BackingStore>> sharedArrayBuffers;
+  };
+
+  // Returns nullptr with a pending exception on the isolate on failure.
+  // ArrayBuffers in `transferList` are detached from the sender.
+  static std::unique_ptr<SerializedMessage> Serialize(
+      v8::Isolate *isolate,
+      v8::Local<v8::Context> context,
+      v8::Local<v8::Value> value,
+      v8::Local<v8::Value> transferList);
+
+  // Takes over the transferred backing stores of `message`
+  static v8::MaybeLocal<v8::Value> Deserialize(
+      v8::Isolate *isolate,
+      v8::Local<v8::Context> context,
+      SerializedMessage &message);
+
+ private:
+  void InstallPort(size_t index, V8Runtime &runtime);
+  facebook::jsi::Value PostMessage(
+      size_t fromIndex,
+      V8Runtime &runtime,
+      const facebook::jsi::Value *args,
+      size_t count);
+  void DispatchMessage(size_t toIndex, SerializedMessage &message);
+
+ private:
+  std::mutex mutex_;
+  bool closed_ = false;
+  std::weak_ptr<V8Runtime *> runtimeRefs_[2];
+  std::shared_ptr<facebook::react::MessageQueueThread> jsQueues_[2];
+  std::string portNames_[2];
+};
+
+} // namespace rnv8
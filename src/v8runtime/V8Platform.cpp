@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8Platform.h"
+
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#if defined(__ANDROID__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace rnv8 {
+
+namespace {
+
+// Same upper bound as the default platform
+constexpr int kMaxWorkerThreadCount = 16;
+
+void SetCurrentWorkerThreadPriority(int priority) {
+#if defined(__APPLE__)
+  pthread_setname_np("rnv8-worker");
+  if (priority > 0) {
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+  }
+#elif defined(__ANDROID__)
+  pthread_setname_np(pthread_self(), "rnv8-worker");
+  setpriority(PRIO_PROCESS, gettid(), priority);
+#endif
+}
+
+// Forwards a delayed foreground task from the worker timer to the JS queue
+class PostForegroundTask final : public v8::Task {
+ public:
+  PostForegroundTask(
+      std::shared_ptr<v8::TaskRunner> taskRunner,
+      std::unique_ptr<v8::Task> task)
+      : taskRunner_(std::move(taskRunner)), task_(std::move(task)) {}
+
+  void Run() override {
+    taskRunner_->PostTask(std::move(task_));
+  }
+
+ private:
+  std::shared_ptr<v8::TaskRunner> taskRunner_;
+  std::unique_ptr<v8::Task> task_;
+};
+
+} // namespace
+
+class JSQueueTaskRunner final
+    : public v8::TaskRunner,
+      public std::enable_shared_from_this<JSQueueTaskRunner> {
+ public:
+  JSQueueTaskRunner(
+      V8Platform &platform,
+      v8::Isolate *isolate,
+      std::shared_ptr<facebook::react::MessageQueueThread> jsQueue)
+      : platform_(platform), isolate_(isolate), jsQueue_(std::move(jsQueue)) {}
+
+  void PostTask(std::unique_ptr<v8::Task> task) override {
+    if (terminated_) {
+      return;
+    }
+    // MessageQueueThread requires copyable functions
+    std::shared_ptr<v8::Task> sharedTask(std::move(task));
+    std::shared_ptr<facebook::react::MessageQueueThread> jsQueue;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!jsQueue_) {
+        // Prewarmed runtime, keep the task until a JS queue is attached
+        pendingTasks_.push_back(std::move(sharedTask));
+        return;
+      }
+      jsQueue = jsQueue_;
+    }
+    PostToJSQueue(*jsQueue, std::move(sharedTask));
+  }
+
+  void PostNonNestableTask(std::unique_ptr<v8::Task> task) override {
+    // Tasks are run from the top of the JS queue and are never nested
+    PostTask(std::move(task));
+  }
+
+  void PostDelayedTask(std::unique_ptr<v8::Task> task, double delayInSeconds)
+      override {
+    if (terminated_) {
+      return;
+    }
+    platform_.CallDelayedOnWorkerThread(
+        std::make_unique<PostForegroundTask>(
+            shared_from_this(), std::move(task)),
+        delayInSeconds);
+  }
+
+  void PostNonNestableDelayedTask(
+      std::unique_ptr<v8::Task> task,
+      double delayInSeconds) override {
+    PostDelayedTask(std::move(task), delayInSeconds);
+  }
+
+  void PostIdleTask(std::unique_ptr<v8::IdleTask> task) override {
+    // Not reachable because IdleTasksEnabled() returns false
+  }
+
+  bool IdleTasksEnabled() override {
+    return false;
+  }
+
+  bool NonNestableTasksEnabled() const override {
+    return true;
+  }
+
+  bool NonNestableDelayedTasksEnabled() const override {
+    return true;
+  }
+
+  void AttachJSQueue(
+      std::shared_ptr<facebook::react::MessageQueueThread> jsQueue) {
+    std::vector<std::shared_ptr<v8::Task>> pendingTasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jsQueue_ = jsQueue;
+      if (!jsQueue_) {
+        // Detached, e.g. for a recycled isolate
+        return;
+      }
+      pendingTasks.swap(pendingTasks_);
+    }
+    for (auto &task : pendingTasks) {
+      PostToJSQueue(*jsQueue, std::move(task));
+    }
+  }
+
+  void Terminate() {
+    terminated_ = true;
+  }
+
+ private:
+  void PostToJSQueue(
+      facebook::react::MessageQueueThread &jsQueue,
+      std::shared_ptr<v8::Task> task) {
+    jsQueue.runOnQueue(
+        [weakThis = weak_from_this(), task = std::move(task)]() {
+          if (auto self = weakThis.lock()) {
+            self->RunTask(*task);
+          }
+        });
+  }
+
+  void RunTask(v8::Task &task) {
+    if (terminated_) {
+      return;
+    }
+    v8::Locker locker(isolate_);
+    v8::Isolate::Scope scopedIsolate(isolate_);
+    v8::HandleScope scopedHandle(isolate_);
+    task.Run();
+  }
+
+ private:
+  V8Platform &platform_;
+  v8::Isolate *isolate_;
+  std::mutex mutex_;
+  std::shared_ptr<facebook::react::MessageQueueThread> jsQueue_;
+  std::vector<std::shared_ptr<v8::Task>> pendingTasks_;
+  std::atomic<bool> terminated_{false};
+};
+
+V8Platform::V8Platform(
+    int workerThreadCount,
+    int workerThreadPriority,
+    std::unique_ptr<v8::TracingController> tracingController)
+    : defaultPlatform_(v8::platform::NewDefaultPlatform(
+          1,
+          v8::platform::IdleTaskSupport::kDisabled,
+          v8::platform::InProcessStackDumping::kDisabled,
+          std::move(tracingController))),
+      workerThreadPriority_(workerThreadPriority) {
+  if (workerThreadCount <= 0) {
+    workerThreadCount =
+        static_cast<int>(std::thread::hardware_concurrency()) - 1;
+  }
+  workerThreadCount = std::clamp(workerThreadCount, 1, kMaxWorkerThreadCount);
+  for (int i = 0; i < workerThreadCount; ++i) {
+    workers_.emplace_back([this]() { RunWorker(); });
+  }
+}
+
+V8Platform::~V8Platform() {
+  {
+    std::lock_guard<std::mutex> lock(workerMutex_);
+    terminated_ = true;
+  }
+  workerCondition_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void V8Platform::RegisterIsolate(
+    v8::Isolate *isolate,
+    std::shared_ptr<facebook::react::MessageQueueThread> jsQueue) {
+  std::lock_guard<std::mutex> lock(runnersMutex_);
+  foregroundTaskRunners_[isolate] =
+      std::make_shared<JSQueueTaskRunner>(*this, isolate, std::move(jsQueue));
+}
+
+void V8Platform::AttachJSQueue(
+    v8::Isolate *isolate,
+    std::shared_ptr<facebook::react::MessageQueueThread> jsQueue) {
+  std::shared_ptr<JSQueueTaskRunner> taskRunner;
+  {
+    std::lock_guard<std::mutex> lock(runnersMutex_);
+    auto it = foregroundTaskRunners_.find(isolate);
+    if (it == foregroundTaskRunners_.end()) {
+      return;
+    }
+    taskRunner = it->second;
+  }
+  taskRunner->AttachJSQueue(std::move(jsQueue));
+}
+
+void V8Platform::UnregisterIsolate(v8::Isolate *isolate) {
+  std::lock_guard<std::mutex> lock(runnersMutex_);
+  auto it = foregroundTaskRunners_.find(isolate);
+  if (it != foregroundTaskRunners_.end()) {
+    // V8 may still hold the runner, drop everything posted from now on.
+    it->second->Terminate();
+    foregroundTaskRunners_.erase(it);
+  }
+}
+
+v8::Platform *V8Platform::GetDefaultPlatform() {
+  return defaultPlatform_.get();
+}
+
+v8::PageAllocator *V8Platform::GetPageAllocator() {
+  return defaultPlatform_->GetPageAllocator();
+}
+
+int V8Platform::NumberOfWorkerThreads() {
+  return static_cast<int>(workers_.size());
+}
+
+std::shared_ptr<v8::TaskRunner> V8Platform::GetForegroundTaskRunner(
+    v8::Isolate *isolate) {
+  {
+    std::lock_guard<std::mutex> lock(runnersMutex_);
+    auto it = foregroundTaskRunners_.find(isolate);
+    if (it != foregroundTaskRunners_.end()) {
+      return it->second;
+    }
+  }
+  return defaultPlatform_->GetForegroundTaskRunner(isolate);
+}
+
+void V8Platform::CallOnWorkerThread(std::unique_ptr<v8::Task> task) {
+  PostWorkerTask(std::move(task), v8::TaskPriority::kUserVisible, 0);
+}
+
+void V8Platform::CallBlockingTaskOnWorkerThread(
+    std::unique_ptr<v8::Task> task) {
+  PostWorkerTask(std::move(task), v8::TaskPriority::kUserBlocking, 0);
+}
+
+void V8Platform::CallLowPriorityTaskOnWorkerThread(
+    std::unique_ptr<v8::Task> task) {
+  PostWorkerTask(std::move(task), v8::TaskPriority::kBestEffort, 0);
+}
+
+void V8Platform::CallDelayedOnWorkerThread(
+    std::unique_ptr<v8::Task> task,
+    double delayInSeconds) {
+  PostWorkerTask(
+      std::move(task), v8::TaskPriority::kUserVisible, delayInSeconds);
+}
+
+bool V8Platform::IdleTasksEnabled(v8::Isolate *isolate) {
+  return false;
+}
+
+std::unique_ptr<v8::JobHandle> V8Platform::CreateJob(
+    v8::TaskPriority priority,
+    std::unique_ptr<v8::JobTask> jobTask) {
+  // The default job implementation posts worker tasks back to this platform
+  return v8::platform::NewDefaultJobHandle(
+      this, priority, std::move(jobTask), NumberOfWorkerThreads());
+}
+
+double V8Platform::MonotonicallyIncreasingTime() {
+  return defaultPlatform_->MonotonicallyIncreasingTime();
+}
+
+double V8Platform::CurrentClockTimeMillis() {
+  return defaultPlatform_->CurrentClockTimeMillis();
+}
+
+v8::TracingController *V8Platform::GetTracingController() {
+  return defaultPlatform_->GetTracingController();
+}
+
+v8::Platform::StackTracePrinter V8Platform::GetStackTracePrinter() {
+  return defaultPlatform_->GetStackTracePrinter();
+}
+
+void V8Platform::PostWorkerTask(
+    std::unique_ptr<v8::Task> task,
+    v8::TaskPriority priority,
+    double delayInSeconds) {
+  {
+    std::lock_guard<std::mutex> lock(workerMutex_);
+    if (terminated_) {
+      return;
+    }
+    if (delayInSeconds > 0) {
+      delayedWorkerTasks_.emplace(
+          MonotonicallyIncreasingTime() + delayInSeconds,
+          std::make_pair(priority, std::move(task)));
+    } else {
+      workerQueues_[static_cast<size_t>(priority)].push_back(std::move(task));
+    }
+  }
+  workerCondition_.notify_one();
+}
+
+std::unique_ptr<v8::Task> V8Platform::PopWorkerTask() {
+  // Called with workerMutex_ held
+  double now = MonotonicallyIncreasingTime();
+  while (!delayedWorkerTasks_.empty() &&
+         delayedWorkerTasks_.begin()->first <= now) {
+    auto it = delayedWorkerTasks_.begin();
+    workerQueues_[static_cast<size_t>(it->second.first)].push_back(
+        std::move(it->second.second));
+    delayedWorkerTasks_.erase(it);
+  }
+
+  for (size_t i = kNumPriorities; i > 0; --i) {
+    auto &queue = workerQueues_[i - 1];
+    if (!queue.empty()) {
+      std::unique_ptr<v8::Task> task = std::move(queue.front());
+      queue.pop_front();
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void V8Platform::RunWorker() {
+  SetCurrentWorkerThreadPriority(workerThreadPriority_);
+
+  std::unique_lock<std::mutex> lock(workerMutex_);
+  while (!terminated_) {
+    std::unique_ptr<v8::Task> task = PopWorkerTask();
+    if (task) {
+      lock.unlock();
+      task->Run();
+      task.reset();
+      lock.lock();
+      continue;
+    }
+
+    if (delayedWorkerTasks_.empty()) {
+      workerCondition_.wait(lock);
+    } else {
+      double delayInSeconds =
+          delayedWorkerTasks_.begin()->first - MonotonicallyIncreasingTime();
+      workerCondition_.wait_for(
+          lock, std::chrono::duration<double>(delayInSeconds));
+    }
+  }
+}
+
+} // namespace rnv8
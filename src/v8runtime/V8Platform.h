@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cxxreact/MessageQueueThread.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "libplatform/libplatform.h"
+#include "v8.h"
+
+namespace rnv8 {
+
+class JSQueueTaskRunner;
+
+// A v8::Platform that runs foreground tasks directly on the runtime's JS queue
+// and background tasks on a worker pool honoring task priorities.
+// Isolates without a registered JS queue fall back to the default platform,
+// whose tasks are run by `v8::platform::PumpMessageLoop()`.
+class V8Platform final : public v8::Platform {
+ public:
+  // `workerThreadCount` 0 to use the number of cores - 1.
+  // `workerThreadPriority` is the nice value of worker threads.
+  // `tracingController` may be null to keep the default one.
+  V8Platform(
+      int workerThreadCount,
+      int workerThreadPriority,
+      std::unique_ptr<v8::TracingController> tracingController = nullptr);
+  ~V8Platform() override;
+
+  // Must be called between `v8::Isolate::Allocate()` and
+  // `v8::Isolate::Initialize()`, because V8 caches the foreground task runner
+  // during initialization. `jsQueue` may be null for prewarmed isolates, the
+  // foreground tasks are then held until `AttachJSQueue()`. Attaching a null
+  // queue detaches the current one.
+  void RegisterIsolate(
+      v8::Isolate *isolate,
+      std::shared_ptr<facebook::react::MessageQueueThread> jsQueue);
+  void AttachJSQueue(
+      v8::Isolate *isolate,
+      std::shared_ptr<facebook::react::MessageQueueThread> jsQueue);
+  void UnregisterIsolate(v8::Isolate *isolate);
+
+  // The underlying platform created by `v8::platform::NewDefaultPlatform()`
+  v8::Platform *GetDefaultPlatform();
+
+  //
+  // v8::Platform implementations
+  //
+ public:
+  v8::PageAllocator *GetPageAllocator() override;
+  int NumberOfWorkerThreads() override;
+  std::shared_ptr<v8::TaskRunner> GetForegroundTaskRunner(
+      v8::Isolate *isolate) override;
+  void CallOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+  void CallBlockingTaskOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+  void CallLowPriorityTaskOnWorkerThread(
+      std::unique_ptr<v8::Task> task) override;
+  void CallDelayedOnWorkerThread(
+      std::unique_ptr<v8::Task> task,
+      double delayInSeconds) override;
+  bool IdleTasksEnabled(v8::Isolate *isolate) override;
+  std::unique_ptr<v8::JobHandle> CreateJob(
+      v8::TaskPriority priority,
+      std::unique_ptr<v8::JobTask> jobTask) override;
+  double MonotonicallyIncreasingTime() override;
+  double CurrentClockTimeMillis() override;
+  v8::TracingController *GetTracingController() override;
+  StackTracePrinter GetStackTracePrinter() override;
+
+ private:
+  void PostWorkerTask(
+      std::unique_ptr<v8::Task> task,
+      v8::TaskPriority priority,
+      double delayInSeconds);
+  std::unique_ptr<v8::Task> PopWorkerTask();
+  void RunWorker();
+
+ private:
+  static constexpr size_t kNumPriorities =
+      static_cast<size_t>(v8::TaskPriority::kUserBlocking) + 1;
+
+  std::unique_ptr<v8::Platform> defaultPlatform_;
+
+  int workerThreadPriority_;
+  std::vector<std::thread> workers_;
+  std::mutex workerMutex_;
+  std::condition_variable workerCondition_;
+  std::deque<std::unique_ptr<v8::Task>> workerQueues_[kNumPriorities];
+  std::multimap<
+      double,
+      std::pair<v8::TaskPriority, std::unique_ptr<v8::Task>>>
+      delayedWorkerTasks_;
+  bool terminated_ = false;
+
+  std::mutex runnersMutex_;
+  std::unordered_map<v8::Isolate *, std::shared_ptr<JSQueueTaskRunner>>
+      foregroundTaskRunners_;
+};
+
+} // namespace rnv8
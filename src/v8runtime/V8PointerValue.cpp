@@ -7,19 +7,33 @@
 
 #include "V8PointerValue.h"
 
+#include <atomic>
+
 namespace rnv8 {
 
+namespace {
+
+std::atomic<size_t> s_liveCount{0};
+
+} // namespace
+
 V8PointerValue::V8PointerValue(
     v8::Isolate *isolate,
     const v8::Local<v8::Value> &value)
-    : isolate_(isolate), value_(isolate, value) {}
+    : isolate_(isolate), value_(isolate, value) {
+  s_liveCount.fetch_add(1, std::memory_order_relaxed);
+}
 
 V8PointerValue::V8PointerValue(
     v8::Isolate *isolate,
     v8::Global<v8::Value> &&value)
-    : isolate_(isolate), value_(std::move(value)) {}
+    : isolate_(isolate), value_(std::move(value)) {
+  s_liveCount.fetch_add(1, std::memory_order_relaxed);
+}
 
-V8PointerValue::~V8PointerValue() {}
+V8PointerValue::~V8PointerValue() {
+  s_liveCount.fetch_sub(1, std::memory_order_relaxed);
+}
 
 v8::Local<v8::Value> V8PointerValue::Get(v8::Isolate *isolate) const {
   v8::EscapableHandleScope scopedHandle(isolate);
@@ -31,6 +45,11 @@ void V8PointerValue::Reset(v8::Isolate *isolate, v8::Local<v8::Value> value) {
   value_.Reset(isolate, value);
 }
 
+// static
+size_t V8PointerValue::GetLiveCount() {
+  return s_liveCount.load(std::memory_order_relaxed);
+}
+
 // static
 V8PointerValue *V8PointerValue::createFromOneByte(
     v8::Isolate *isolate,
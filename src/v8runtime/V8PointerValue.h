@@ -33,6 +33,9 @@ class V8PointerValue final : public V8Runtime::PointerValue {
   static V8PointerValue *
   createFromUtf8(v8::Isolate *isolate, const uint8_t *str, size_t length);
 
+  // Number of instances not yet deleted, across all runtimes
+  static size_t GetLiveCount();
+
  private:
   void invalidate() override;
 
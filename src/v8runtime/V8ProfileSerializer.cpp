@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8ProfileSerializer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace rnv8 {
+
+namespace {
+
+void WriteJSONString(std::ostream &out, const char *string) {
+  out << '"';
+  for (const char *p = string; p && *p; ++p) {
+    unsigned char c = static_cast<unsigned char>(*p);
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\r':
+        out << "\\r";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if (c < 0x20) {
+          char escaped[7];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          out << escaped;
+        } else {
+          out << *p;
+        }
+    }
+  }
+  out << '"';
+}
+
+// DevTools line and column numbers are 0-based
+int ToZeroBased(int number) {
+  return number > 0 ? number - 1 : -1;
+}
+
+void WriteCpuProfileNode(std::ostream &out, const v8::CpuProfileNode &node) {
+  out << "{\"id\":" << node.GetNodeId() << ",\"callFrame\":{\"functionName\":";
+  WriteJSONString(out, node.GetFunctionNameStr());
+  out << ",\"scriptId\":\"" << node.GetScriptId() << "\",\"url\":";
+  WriteJSONString(out, node.GetScriptResourceNameStr());
+  out << ",\"lineNumber\":" << ToZeroBased(node.GetLineNumber())
+      << ",\"columnNumber\":" << ToZeroBased(node.GetColumnNumber())
+      << "},\"hitCount\":" << node.GetHitCount();
+  int childrenCount = node.GetChildrenCount();
+  if (childrenCount > 0) {
+    out << ",\"children\":[";
+    for (int i = 0; i < childrenCount; ++i) {
+      out << (i > 0 ? "," : "") << node.GetChild(i)->GetNodeId();
+    }
+    out << "]";
+  }
+  out << "}";
+}
+
+void WriteJSONString(
+    std::ostream &out,
+    v8::Isolate *isolate,
+    v8::Local<v8::String> string) {
+  if (string.IsEmpty()) {
+    out << "\"\"";
+    return;
+  }
+  v8::String::Utf8Value utf8(isolate, string);
+  WriteJSONString(out, *utf8);
+}
+
+void WriteAllocationNode(
+    std::ostream &out,
+    v8::Isolate *isolate,
+    const v8::AllocationProfile::Node &node) {
+  size_t selfSize = 0;
+  for (const auto &allocation : node.allocations) {
+    selfSize += allocation.size * allocation.count;
+  }
+  out << "{\"callFrame\":{\"functionName\":";
+  WriteJSONString(out, isolate, node.name);
+  out << ",\"scriptId\":\"" << node.script_id << "\",\"url\":";
+  WriteJSONString(out, isolate, node.script_name);
+  out << ",\"lineNumber\":" << ToZeroBased(node.line_number)
+      << ",\"columnNumber\":" << ToZeroBased(node.column_number)
+      << "},\"selfSize\":" << selfSize << ",\"id\":" << node.node_id
+      << ",\"children\":[";
+  // The depth is bounded by the stack depth of the sampling heap profiler
+  for (size_t i = 0; i < node.children.size(); ++i) {
+    if (i > 0) {
+      out << ",";
+    }
+    WriteAllocationNode(out, isolate, *node.children[i]);
+  }
+  out << "]}";
+}
+
+// Writes the chunks of a serialized profile straight to a file
+class FileOutputStream final : public v8::OutputStream {
+ public:
+  explicit FileOutputStream(FILE *file) : file_(file) {}
+
+  int GetChunkSize() override {
+    return kChunkSize;
+  }
+
+  WriteResult WriteAsciiChunk(char *data, int size) override {
+    size_t written = fwrite(data, 1, static_cast<size_t>(size), file_);
+    if (written != static_cast<size_t>(size)) {
+      failed_ = true;
+      return kAbort;
+    }
+    return kContinue;
+  }
+
+  void EndOfStream() override {}
+
+  bool Failed() const {
+    return failed_;
+  }
+
+ private:
+  static constexpr int kChunkSize = 64 * 1024;
+
+  FILE *file_;
+  bool failed_ = false;
+};
+
+} // namespace
+
+// static
+bool V8ProfileSerializer::WriteCpuProfile(
+    const v8::CpuProfile &profile,
+    const std::string &filename) {
+  std::ofstream out(filename, std::ios::out | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  out << "{\"nodes\":[";
+  // Iterative pre-order walk, deep JS stacks would overflow a recursive one
+  std::vector<const v8::CpuProfileNode *> stack{profile.GetTopDownRoot()};
+  bool first = true;
+  while (!stack.empty()) {
+    const v8::CpuProfileNode *node = stack.back();
+    stack.pop_back();
+    if (!first) {
+      out << ",";
+    }
+    first = false;
+    WriteCpuProfileNode(out, *node);
+    for (int i = node->GetChildrenCount() - 1; i >= 0; --i) {
+      stack.push_back(node->GetChild(i));
+    }
+  }
+
+  int64_t startTime = profile.GetStartTime();
+  out << "],\"startTime\":" << startTime
+      << ",\"endTime\":" << profile.GetEndTime() << ",\"samples\":[";
+  int samplesCount = profile.GetSamplesCount();
+  for (int i = 0; i < samplesCount; ++i) {
+    out << (i > 0 ? "," : "") << profile.GetSample(i)->GetNodeId();
+  }
+  out << "],\"timeDeltas\":[";
+  int64_t lastTimestamp = startTime;
+  for (int i = 0; i < samplesCount; ++i) {
+    int64_t timestamp = profile.GetSampleTimestamp(i);
+    out << (i > 0 ? "," : "") << timestamp - lastTimestamp;
+    lastTimestamp = timestamp;
+  }
+  out << "]}";
+
+  out.close();
+  return !out.fail();
+}
+
+// static
+bool V8ProfileSerializer::WriteSamplingHeapProfile(
+    v8::Isolate *isolate,
+    v8::AllocationProfile &profile,
+    const std::string &filename) {
+  std::ofstream out(filename, std::ios::out | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  v8::HandleScope scopedHandle(isolate);
+  out << "{\"head\":";
+  WriteAllocationNode(out, isolate, *profile.GetRootNode());
+  out << ",\"samples\":[";
+  bool first = true;
+  for (const auto &sample : profile.GetSamples()) {
+    if (!first) {
+      out << ",";
+    }
+    first = false;
+    out << "{\"size\":" << sample.size * sample.count
+        << ",\"nodeId\":" << sample.node_id
+        << ",\"ordinal\":" << sample.sample_id << "}";
+  }
+  out << "]}";
+
+  out.close();
+  return !out.fail();
+}
+
+// static
+bool V8ProfileSerializer::WriteHeapSnapshot(
+    const v8::HeapSnapshot &snapshot,
+    const std::string &filename) {
+  FILE *file = fopen(filename.c_str(), "w");
+  if (!file) {
+    return false;
+  }
+  FileOutputStream stream(file);
+  snapshot.Serialize(&stream, v8::HeapSnapshot::kJSON);
+  bool failed = stream.Failed();
+  failed |= fclose(file) != 0;
+  return !failed;
+}
+
+} // namespace rnv8
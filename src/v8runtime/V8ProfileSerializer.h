@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <string>
+#include "v8-profiler.h"
+
+namespace rnv8 {
+
+// Writes V8 profiles to files in the formats loaded by Chrome DevTools
+class V8ProfileSerializer final {
+ public:
+  V8ProfileSerializer() = delete;
+
+  // Writes a .cpuprofile. Returns false if the file cannot be written.
+  static bool WriteCpuProfile(
+      const v8::CpuProfile &profile,
+      const std::string &filename);
+
+  // Writes a .heapprofile. Returns false if the file cannot be written.
+  static bool WriteSamplingHeapProfile(
+      v8::Isolate *isolate,
+      v8::AllocationProfile &profile,
+      const std::string &filename);
+
+  // Streams a .heapsnapshot to the file in chunks, without building the JSON
+  // in memory. Returns false if the file cannot be written.
+  static bool WriteHeapSnapshot(
+      const v8::HeapSnapshot &snapshot,
+      const std::string &filename);
+};
+
+} // namespace rnv8
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8PromiseResolver.h"
+
+#include <algorithm>
+#include "JSIV8ValueConverter.h"
+#include "V8Runtime.h"
+
+namespace jsi = facebook::jsi;
+
+namespace rnv8 {
+
+V8PromiseResolver::V8PromiseResolver(
+    V8Runtime &runtime,
+    v8::Local<v8::Promise::Resolver> resolver)
+    : runtimeRef_(runtime.selfRef_),
+      jsQueue_(runtime.jsQueue_),
+      resolver_(std::make_shared<v8::Global<v8::Promise::Resolver>>(
+          runtime.isolate_,
+          resolver)) {
+  auto &resolvers = runtime.promiseResolvers_;
+  resolvers.erase(
+      std::remove_if(
+          resolvers.begin(),
+          resolvers.end(),
+          [](const auto &weakResolver) { return weakResolver.expired(); }),
+      resolvers.end());
+  resolvers.push_back(resolver_);
+}
+
+V8PromiseResolver::~V8PromiseResolver() {
+  if (!settled_.exchange(true)) {
+    // The global handle can only be released on the JS thread
+    PostSettle(Settlement::kNone, nullptr, {});
+  }
+}
+
+void V8PromiseResolver::Resolve(ValueFactory factory) {
+  if (!settled_.exchange(true)) {
+    PostSettle(Settlement::kResolve, std::move(factory), {});
+  }
+}
+
+void V8PromiseResolver::Reject(ValueFactory factory) {
+  if (!settled_.exchange(true)) {
+    PostSettle(Settlement::kReject, std::move(factory), {});
+  }
+}
+
+void V8PromiseResolver::Reject(const std::string &message) {
+  if (!settled_.exchange(true)) {
+    PostSettle(Settlement::kReject, nullptr, message);
+  }
+}
+
+void V8PromiseResolver::PostSettle(
+    Settlement settlement,
+    ValueFactory factory,
+    std::string message) {
+  jsQueue_->runOnQueue([runtimeRef = runtimeRef_,
+                        resolver = resolver_,
+                        settlement,
+                        factory = std::move(factory),
+                        message = std::move(message)]() {
+    std::shared_ptr<V8Runtime *> runtime = runtimeRef.lock();
+    if (!runtime) {
+      // `~V8Runtime()` already released the handle under the isolate lock
+      return;
+    }
+    Settle(**runtime, *resolver, settlement, factory, message);
+  });
+}
+
+// static
+void V8PromiseResolver::Settle(
+    V8Runtime &runtime,
+    v8::Global<v8::Promise::Resolver> &resolver,
+    Settlement settlement,
+    const ValueFactory &factory,
+    const std::string &message) {
+  jsi::Value value;
+  std::string errorMessage = message;
+  bool hasValue = static_cast<bool>(factory);
+  if (settlement != Settlement::kNone && factory) {
+    try {
+      value = factory(runtime);
+    } catch (const jsi::JSError &error) {
+      value = jsi::Value(runtime, error.value());
+      settlement = Settlement::kReject;
+    } catch (const std::exception &ex) {
+      errorMessage = ex.what();
+      hasValue = false;
+      settlement = Settlement::kReject;
+    }
+  }
+
+  v8::Isolate *isolate = runtime.isolate_;
+  v8::Locker locker(isolate);
+  v8::Isolate::Scope scopedIsolate(isolate);
+  v8::HandleScope scopedHandle(isolate);
+  v8::Local<v8::Context> context = runtime.context_.Get(isolate);
+  v8::Context::Scope scopedContext(context);
+
+  if (settlement != Settlement::kNone) {
+    v8::Local<v8::Value> v8Value;
+    if (hasValue) {
+      v8Value = JSIV8ValueConverter::ToV8Value(runtime, value);
+    } else if (settlement == Settlement::kReject) {
+      v8Value = v8::Exception::Error(
+          v8::String::NewFromUtf8(
+              isolate, errorMessage.c_str(), v8::NewStringType::kNormal)
+              .ToLocalChecked());
+    } else {
+      v8Value = v8::Undefined(isolate);
+    }
+
+    v8::Local<v8::Promise::Resolver> v8Resolver = resolver.Get(isolate);
+    if (settlement == Settlement::kResolve) {
+      v8Resolver->Resolve(context, v8Value).FromMaybe(false);
+    } else {
+      v8Resolver->Reject(context, v8Value).FromMaybe(false);
+    }
+    // Nothing else runs the reactions with the auto policy until the next
+    // call into JS returns
+    if (isolate->GetMicrotasksPolicy() == v8::MicrotasksPolicy::kAuto) {
+      isolate->PerformMicrotaskCheckpoint();
+    }
+  }
+  resolver.Reset();
+}
+
+} // namespace rnv8
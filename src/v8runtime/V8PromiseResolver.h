@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cxxreact/MessageQueueThread.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include "jsi/jsi.h"
+#include "v8.h"
+
+namespace rnv8 {
+
+class V8Runtime;
+
+// Settles a promise created by `V8Runtime::CreatePromise()`. The methods can
+// be called from any thread, the promise is settled on the JS queue and only
+// the first call takes effect. A resolver destroyed before settling leaves the
+// promise pending.
+class V8PromiseResolver final {
+ public:
+  // Called on the JS thread to create the settled value
+  using ValueFactory =
+      std::function<facebook::jsi::Value(facebook::jsi::Runtime &runtime)>;
+
+  V8PromiseResolver(
+      V8Runtime &runtime,
+      v8::Local<v8::Promise::Resolver> resolver);
+  ~V8PromiseResolver();
+
+  V8PromiseResolver(const V8PromiseResolver &) = delete;
+  V8PromiseResolver &operator=(const V8PromiseResolver &) = delete;
+
+  // Resolves with undefined when `factory` is empty. A jsi::JSError thrown by
+  // `factory` rejects the promise with its value instead, any other
+  // std::exception with an Error of its message.
+  void Resolve(ValueFactory factory = nullptr);
+  void Reject(ValueFactory factory);
+  // Rejects with an Error of the given message
+  void Reject(const std::string &message);
+
+ private:
+  enum struct Settlement : uint8_t {
+    kNone = 0,
+    kResolve,
+    kReject,
+  };
+
+  using ResolverHandle = std::shared_ptr<v8::Global<v8::Promise::Resolver>>;
+
+  void PostSettle(
+      Settlement settlement,
+      ValueFactory factory,
+      std::string message);
+  static void Settle(
+      V8Runtime &runtime,
+      v8::Global<v8::Promise::Resolver> &resolver,
+      Settlement settlement,
+      const ValueFactory &factory,
+      const std::string &message);
+
+ private:
+  std::weak_ptr<V8Runtime *> runtimeRef_;
+  std::shared_ptr<facebook::react::MessageQueueThread> jsQueue_;
+  ResolverHandle resolver_;
+  std::atomic<bool> settled_{false};
+};
+
+} // namespace rnv8
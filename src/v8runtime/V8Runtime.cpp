@@ -7,29 +7,486 @@
 
 #include "V8Runtime.h"
 
+#include <cxxreact/SystraceSection.h>
 #include <glog/logging.h>
+#include <cstring>
 #include <filesystem>
 #include <mutex>
 #include <sstream>
+#include "DeferredFinalizer.h"
 #include "HostProxy.h"
+#include "IsolateDisposer.h"
 #include "JSIV8ValueConverter.h"
 #include "V8Inspector.h"
+#include "V8Instrumentation.h"
+#include "V8Platform.h"
 #include "V8PointerValue.h"
+#include "V8ProfileSerializer.h"
+#include "V8PromiseResolver.h"
+#include "V8Timers.h"
+#include "V8TracingController.h"
+#include "V8Watchdog.h"
+#include "cppgc/allocation.h"
 #include "jsi/jsilib.h"
 
 namespace jsi = facebook::jsi;
 
 namespace rnv8 {
 
+// Property names of `global._v8runtime()`, internalized once per runtime
+// instead of on every call. Keyed by the address of the string literals.
+class RuntimeInfoKeys {
+ public:
+  explicit RuntimeInfoKeys(v8::Isolate *isolate) : isolate_(isolate) {}
+
+  v8::Local<v8::String> Get(const char *key) {
+    auto it = keys_.find(key);
+    if (it != keys_.end()) {
+      return it->second.Get(isolate_);
+    }
+    v8::Local<v8::String> string =
+        v8::String::NewFromUtf8(isolate_, key, v8::NewStringType::kInternalized)
+            .ToLocalChecked();
+    keys_.emplace(key, v8::Global<v8::String>(isolate_, string));
+    return string;
+  }
+
+ private:
+  v8::Isolate *isolate_;
+  std::unordered_map<const char *, v8::Global<v8::String>> keys_;
+};
+
 namespace {
 
 const char kHostFunctionProxyProp[] = "__hostFunctionProxy";
 
+const char kCpuProfileTitle[] = "rnv8";
+
+void SetValue(
+    v8::Local<v8::Context> context,
+    RuntimeInfoKeys &keys,
+    v8::Local<v8::Object> object,
+    const char *key,
+    v8::Local<v8::Value> value) {
+  object->Set(context, keys.Get(key), value).Check();
+}
+
+void SetNumber(
+    v8::Local<v8::Context> context,
+    RuntimeInfoKeys &keys,
+    v8::Local<v8::Object> object,
+    const char *key,
+    double value) {
+  v8::Isolate *isolate = context->GetIsolate();
+  SetValue(context, keys, object, key, v8::Number::New(isolate, value));
+}
+
+void SetString(
+    v8::Local<v8::Context> context,
+    RuntimeInfoKeys &keys,
+    v8::Local<v8::Object> object,
+    const char *key,
+    const std::string &value) {
+  SetValue(
+      context,
+      keys,
+      object,
+      key,
+      v8::String::NewFromUtf8(
+          context->GetIsolate(),
+          value.c_str(),
+          v8::NewStringType::kNormal,
+          static_cast<int>(value.length()))
+          .ToLocalChecked());
+}
+
+// For `global._v8runtime().gc`
+v8::Local<v8::Object> CreateGCInfo(
+    v8::Local<v8::Context> context,
+    RuntimeInfoKeys &keys,
+    const V8GCStats &stats) {
+  v8::Isolate *isolate = context->GetIsolate();
+  v8::Local<v8::Object> gcInfo = v8::Object::New(isolate);
+  SetNumber(context, keys, gcInfo, "uptimeMs", stats.uptimeMs);
+  for (size_t i = 0; i < stats.kinds.size(); ++i) {
+    const V8GCKindStats &kindStats = stats.kinds[i];
+    v8::Local<v8::Object> kindInfo = v8::Object::New(isolate);
+    SetNumber(context, keys, kindInfo, "count", kindStats.count);
+    SetNumber(context, keys, kindInfo, "totalPauseMs", kindStats.totalPauseMs);
+    SetNumber(context, keys, kindInfo, "maxPauseMs", kindStats.maxPauseMs);
+    v8::Local<v8::Array> buckets =
+        v8::Array::New(isolate, V8GCKindStats::kBucketCount);
+    for (uint32_t j = 0; j < V8GCKindStats::kBucketCount; ++j) {
+      buckets
+          ->Set(
+              context,
+              j,
+              v8::Number::New(isolate, kindStats.pauseBuckets[j]))
+          .Check();
+    }
+    SetValue(context, keys, kindInfo, "pauseHistogramUs", buckets);
+    SetValue(
+        context,
+        keys,
+        gcInfo,
+        V8GCTelemetry::GetKindName(static_cast<V8GCKind>(i)),
+        kindInfo);
+  }
+
+  v8::Local<v8::Array> recentEvents =
+      v8::Array::New(isolate, static_cast<int>(stats.recentEvents.size()));
+  for (uint32_t i = 0; i < stats.recentEvents.size(); ++i) {
+    const V8GCEvent &event = stats.recentEvents[i];
+    v8::Local<v8::Object> eventInfo = v8::Object::New(isolate);
+    SetValue(
+        context,
+        keys,
+        eventInfo,
+        "kind",
+        keys.Get(V8GCTelemetry::GetKindName(event.kind)));
+    SetNumber(context, keys, eventInfo, "startTimeMs", event.startTimeMs);
+    SetNumber(context, keys, eventInfo, "pauseMs", event.pauseMs);
+    SetNumber(
+        context,
+        keys,
+        eventInfo,
+        "usedHeapSizeBefore",
+        event.usedHeapSizeBefore);
+    SetNumber(
+        context, keys, eventInfo, "usedHeapSizeAfter", event.usedHeapSizeAfter);
+    recentEvents->Set(context, i, eventInfo).Check();
+  }
+  SetValue(context, keys, gcInfo, "recentEvents", recentEvents);
+  return gcInfo;
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Header fields of V8's serialized code cache, the same layout
+// `UseFakeSourceIfNeeded()` relies on
+constexpr size_t kCodeCacheMagicNumberOffset = 0;
+constexpr size_t kCodeCacheVersionHashOffset = 4;
+constexpr size_t kCodeCacheSourceHashOffset = 8;
+constexpr size_t kCodeCacheFlagHashOffset = 12;
+constexpr int kCodeCacheHeaderSize = 16;
+
+uint32_t ReadCodeCacheHeaderField(const uint8_t *data, size_t offset) {
+  return (data[offset] << 0) | (data[offset + 1] << 8) |
+      (data[offset + 2] << 16) | (data[offset + 3] << 24);
+}
+
+V8CodeCacheRejectReason GetCodeCacheRejectReason(
+    const v8::ScriptCompiler::CachedData &rejectedData,
+    const v8::ScriptCompiler::CachedData &newData) {
+  if (rejectedData.length < kCodeCacheHeaderSize ||
+      newData.length < kCodeCacheHeaderSize) {
+    return V8CodeCacheRejectReason::kInvalidHeader;
+  }
+  auto differs = [&](size_t offset) {
+    return ReadCodeCacheHeaderField(rejectedData.data, offset) !=
+        ReadCodeCacheHeaderField(newData.data, offset);
+  };
+  if (differs(kCodeCacheMagicNumberOffset)) {
+    return V8CodeCacheRejectReason::kMagicNumberMismatch;
+  }
+  if (differs(kCodeCacheVersionHashOffset)) {
+    return V8CodeCacheRejectReason::kVersionMismatch;
+  }
+  if (differs(kCodeCacheSourceHashOffset)) {
+    return V8CodeCacheRejectReason::kSourceMismatch;
+  }
+  if (differs(kCodeCacheFlagHashOffset)) {
+    return V8CodeCacheRejectReason::kFlagsMismatch;
+  }
+  return V8CodeCacheRejectReason::kChecksumMismatch;
+}
+
+const char *ToString(V8CodeCacheResult result) {
+  switch (result) {
+    case V8CodeCacheResult::kDisabled:
+      return "disabled";
+    case V8CodeCacheResult::kMiss:
+      return "miss";
+    case V8CodeCacheResult::kHit:
+      return "hit";
+    case V8CodeCacheResult::kRejected:
+      return "rejected";
+    case V8CodeCacheResult::kRecycled:
+      return "recycled";
+  }
+  return "unknown";
+}
+
+const char *ToString(V8CodeCacheRejectReason reason) {
+  switch (reason) {
+    case V8CodeCacheRejectReason::kNone:
+      return "none";
+    case V8CodeCacheRejectReason::kInvalidHeader:
+      return "invalidHeader";
+    case V8CodeCacheRejectReason::kMagicNumberMismatch:
+      return "magicNumberMismatch";
+    case V8CodeCacheRejectReason::kVersionMismatch:
+      return "versionMismatch";
+    case V8CodeCacheRejectReason::kSourceMismatch:
+      return "sourceMismatch";
+    case V8CodeCacheRejectReason::kFlagsMismatch:
+      return "flagsMismatch";
+    case V8CodeCacheRejectReason::kChecksumMismatch:
+      return "checksumMismatch";
+    case V8CodeCacheRejectReason::kUnknown:
+      return "unknown";
+  }
+  return "unknown";
+}
+
+// For `global._v8runtime().codeCache`
+v8::Local<v8::Object> CreateCodeCacheInfo(
+    v8::Local<v8::Context> context,
+    RuntimeInfoKeys &keys,
+    const V8CodeCacheStats &stats) {
+  v8::Isolate *isolate = context->GetIsolate();
+  v8::Local<v8::Object> codeCacheInfo = v8::Object::New(isolate);
+  SetNumber(context, keys, codeCacheInfo, "hitCount", stats.hitCount);
+  SetNumber(context, keys, codeCacheInfo, "missCount", stats.missCount);
+  SetNumber(
+      context, keys, codeCacheInfo, "rejectedCount", stats.rejectedCount);
+  SetNumber(
+      context, keys, codeCacheInfo, "recycledCount", stats.recycledCount);
+
+  v8::Local<v8::Array> records =
+      v8::Array::New(isolate, static_cast<int>(stats.records.size()));
+  for (uint32_t i = 0; i < stats.records.size(); ++i) {
+    const V8CodeCacheRecord &record = stats.records[i];
+    v8::Local<v8::Object> recordInfo = v8::Object::New(isolate);
+    SetString(context, keys, recordInfo, "sourceURL", record.sourceURL);
+    SetValue(
+        context, keys, recordInfo, "result", keys.Get(ToString(record.result)));
+    SetValue(
+        context,
+        keys,
+        recordInfo,
+        "rejectReason",
+        keys.Get(ToString(record.rejectReason)));
+    SetNumber(context, keys, recordInfo, "fileSize", record.fileSize);
+    SetNumber(context, keys, recordInfo, "loadMs", record.loadMs);
+    SetNumber(context, keys, recordInfo, "compileMs", record.compileMs);
+    SetNumber(context, keys, recordInfo, "saveMs", record.saveMs);
+    SetNumber(context, keys, recordInfo, "savedSize", record.savedSize);
+    records->Set(context, i, recordInfo).Check();
+  }
+  SetValue(context, keys, codeCacheInfo, "records", records);
+  return codeCacheInfo;
+}
+
+// For `global._v8runtime().memory`
+v8::Local<v8::Object> CreateMemoryInfo(
+    v8::Local<v8::Context> context,
+    RuntimeInfoKeys &keys,
+    const V8HeapInfo &heapInfo) {
+  v8::Isolate *isolate = context->GetIsolate();
+  v8::Local<v8::Object> memoryInfo = v8::Object::New(isolate);
+  // Same names as `performance.memory` of browsers
+  SetNumber(
+      context, keys, memoryInfo, "jsHeapSizeLimit", heapInfo.heapSizeLimit);
+  SetNumber(
+      context, keys, memoryInfo, "totalJSHeapSize", heapInfo.totalHeapSize);
+  SetNumber(context, keys, memoryInfo, "usedJSHeapSize", heapInfo.usedHeapSize);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "totalAvailableSize",
+      heapInfo.totalAvailableSize);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "totalPhysicalSize",
+      heapInfo.totalPhysicalSize);
+  SetNumber(
+      context, keys, memoryInfo, "externalMemory", heapInfo.externalMemory);
+  SetNumber(
+      context, keys, memoryInfo, "mallocedMemory", heapInfo.mallocedMemory);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "peakMallocedMemory",
+      heapInfo.peakMallocedMemory);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "globalHandlesSize",
+      heapInfo.globalHandlesSize);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "usedGlobalHandlesSize",
+      heapInfo.usedGlobalHandlesSize);
+  SetNumber(
+      context, keys, memoryInfo, "nativeContexts", heapInfo.nativeContexts);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "detachedContexts",
+      heapInfo.detachedContexts);
+  if (heapInfo.code) {
+    const V8HeapCodeInfo &code = *heapInfo.code;
+    v8::Local<v8::Object> codeInfo = v8::Object::New(isolate);
+    SetNumber(
+        context,
+        keys,
+        codeInfo,
+        "codeAndMetadataSize",
+        code.codeAndMetadataSize);
+    SetNumber(
+        context,
+        keys,
+        codeInfo,
+        "bytecodeAndMetadataSize",
+        code.bytecodeAndMetadataSize);
+    SetNumber(
+        context,
+        keys,
+        codeInfo,
+        "externalScriptSourceSize",
+        code.externalScriptSourceSize);
+    SetNumber(
+        context,
+        keys,
+        codeInfo,
+        "cpuProfilerMetadataSize",
+        code.cpuProfilerMetadataSize);
+    SetValue(context, keys, memoryInfo, "code", codeInfo);
+  }
+
+  v8::Local<v8::Object> spaces = v8::Object::New(isolate);
+  for (const V8HeapSpaceInfo &space : heapInfo.spaces) {
+    v8::Local<v8::Object> spaceInfo = v8::Object::New(isolate);
+    SetNumber(context, keys, spaceInfo, "size", space.size);
+    SetNumber(context, keys, spaceInfo, "used", space.used);
+    SetNumber(context, keys, spaceInfo, "available", space.available);
+    SetNumber(context, keys, spaceInfo, "physicalSize", space.physicalSize);
+    spaces
+        ->Set(
+            context,
+            v8::String::NewFromUtf8(
+                isolate,
+                space.name.c_str(),
+                v8::NewStringType::kInternalized,
+                static_cast<int>(space.name.length()))
+                .ToLocalChecked(),
+            spaceInfo)
+        .Check();
+  }
+  SetValue(context, keys, memoryInfo, "spaces", spaces);
+
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "livePointerValues",
+      heapInfo.livePointerValues);
+  SetNumber(
+      context, keys, memoryInfo, "liveHostObjects", heapInfo.liveHostObjects);
+  SetNumber(
+      context,
+      keys,
+      memoryInfo,
+      "liveNativeStates",
+      heapInfo.liveNativeStates);
+  return memoryInfo;
+}
+
+// Embedder id for cppgc wrappers, checked by V8 before tracing field 1
+constexpr uint16_t kEmbedderId = 0x7638; // "v8"
+
+// The first member must be the embedder id, see v8::WrapperDescriptor
+struct WrapperTypeInfo {
+  uint16_t embedderId;
+  uint16_t internalFieldType;
+};
+
+uint8_t *GetArrayBufferDataPointer(v8::ArrayBuffer *arrayBuffer) {
+#if V8_MAJOR_VERSION >= 10
+  // Reads the pointer directly without retaining the backing store
+  return reinterpret_cast<uint8_t *>(arrayBuffer->Data());
+#else
+  return reinterpret_cast<uint8_t *>(arrayBuffer->GetBackingStore()->Data());
+#endif
+}
+
+size_t GetTypedArrayElementSize(V8Runtime::TypedArrayType type) {
+  switch (type) {
+    case V8Runtime::TypedArrayType::kUint8:
+      return sizeof(uint8_t);
+    case V8Runtime::TypedArrayType::kInt32:
+      return sizeof(int32_t);
+    case V8Runtime::TypedArrayType::kFloat32:
+      return sizeof(float);
+    case V8Runtime::TypedArrayType::kFloat64:
+      return sizeof(double);
+  }
+  return 0;
+}
+
+// Owns what the isolate references until it is disposed
+struct DisposableIsolate {
+  DisposableIsolate(
+      v8::Isolate *isolate,
+      std::shared_ptr<v8::ArrayBuffer::Allocator> arrayBufferAllocator,
+      std::unique_ptr<v8::StartupData> snapshotBlob,
+      std::unique_ptr<V8RuntimeConfig> config)
+      : isolate(isolate),
+        arrayBufferAllocator(std::move(arrayBufferAllocator)),
+        snapshotBlob(std::move(snapshotBlob)),
+        config(std::move(config)) {}
+
+  ~DisposableIsolate() {
+    isolate->Dispose();
+  }
+
+  v8::Isolate *isolate;
+  std::shared_ptr<v8::ArrayBuffer::Allocator> arrayBufferAllocator;
+  std::unique_ptr<v8::StartupData> snapshotBlob;
+  // Owns the snapshot blob data
+  std::unique_ptr<V8RuntimeConfig> config;
+};
+
 } // namespace
 
 // static
 std::unique_ptr<v8::Platform> V8Runtime::s_platform = nullptr;
-std::mutex s_platform_mutex; // protects s_platform
+V8Platform *V8Runtime::s_customPlatform = nullptr;
+std::mutex s_platform_mutex; // protects s_platform and s_customPlatform
+
+// static
+std::unique_ptr<V8Runtime::RecycledIsolate> V8Runtime::s_recycledIsolate =
+    nullptr;
+std::mutex s_recycledIsolateMutex; // protects s_recycledIsolate
+
+V8Runtime::RecycledIsolate::~RecycledIsolate() {
+  if (!isolate) {
+    return;
+  }
+  {
+    // Releasing the compiled scripts resets global handles
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope scopedIsolate(isolate);
+    scripts.clear();
+  }
+  if (auto *platform = s_customPlatform) {
+    platform->UnregisterIsolate(isolate);
+  }
+  isolate->Dispose();
+}
 
 V8Runtime::V8Runtime(
     std::unique_ptr<V8RuntimeConfig> config,
@@ -38,7 +495,25 @@ V8Runtime::V8Runtime(
   {
     const std::lock_guard<std::mutex> lock(s_platform_mutex);
     if (!s_platform) {
-      s_platform = v8::platform::NewDefaultPlatform();
+      std::unique_ptr<v8::TracingController> tracingController;
+      if (!config_->v8TraceCategories.empty()) {
+        tracingController =
+            std::make_unique<V8TracingController>(config_->v8TraceCategories);
+      }
+      if (config_->enableCustomPlatform) {
+        auto platform = std::make_unique<V8Platform>(
+            config_->platformWorkerThreadCount,
+            config_->platformWorkerThreadPriority,
+            std::move(tracingController));
+        s_customPlatform = platform.get();
+        s_platform = std::move(platform);
+      } else {
+        s_platform = v8::platform::NewDefaultPlatform(
+            0,
+            v8::platform::IdleTaskSupport::kDisabled,
+            v8::platform::InProcessStackDumping::kDisabled,
+            std::move(tracingController));
+      }
       v8::V8::InitializeICU();
       v8::V8::InitializePlatform(s_platform.get());
 #if TARGET_OS_IOS
@@ -50,18 +525,48 @@ V8Runtime::V8Runtime(
     }
   }
 
-  arrayBufferAllocator_.reset(
-      v8::ArrayBuffer::Allocator::NewDefaultAllocator());
-  v8::Isolate::CreateParams createParams;
-  createParams.array_buffer_allocator = arrayBufferAllocator_.get();
-  if (config_->snapshotBlob) {
-    snapshotBlob_ = std::make_unique<v8::StartupData>();
-    snapshotBlob_->data = config_->snapshotBlob->c_str();
-    snapshotBlob_->raw_size = static_cast<int>(config_->snapshotBlob->size());
-    createParams.snapshot_blob = snapshotBlob_.get();
+  if (config_->enableDeferredFinalization) {
+    deferredFinalizer_ = std::make_unique<DeferredFinalizer>();
+  }
+
+  std::unique_ptr<RecycledIsolate> recycledIsolate;
+  if (config_->enableIsolateRecycling) {
+    const std::lock_guard<std::mutex> lock(s_recycledIsolateMutex);
+    recycledIsolate = std::move(s_recycledIsolate);
+  }
+  if (recycledIsolate &&
+      !IsSameSnapshotBlob(
+          recycledIsolate->snapshotBlobData.get(),
+          config_->snapshotBlob.get())) {
+    LOG(INFO) << "[rnv8] Snapshot blob changed, not reusing the isolate";
+    recycledIsolate.reset();
   }
 
-  isolate_ = v8::Isolate::New(createParams);
+  if (recycledIsolate) {
+    isolate_ = recycledIsolate->isolate;
+    recycledIsolate->isolate = nullptr;
+    arrayBufferAllocator_ = std::move(recycledIsolate->arrayBufferAllocator);
+    snapshotBlob_ = std::move(recycledIsolate->snapshotBlob);
+    config_->snapshotBlob = std::move(recycledIsolate->snapshotBlobData);
+    recycledScripts_ = std::move(recycledIsolate->scripts);
+    if (auto *platform = s_customPlatform) {
+      platform->AttachJSQueue(isolate_, jsQueue);
+    }
+  } else {
+    arrayBufferAllocator_.reset(
+        v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+    v8::Isolate::CreateParams createParams;
+    createParams.array_buffer_allocator_shared = arrayBufferAllocator_;
+    if (config_->snapshotBlob) {
+      snapshotBlob_ = std::make_unique<v8::StartupData>();
+      snapshotBlob_->data = config_->snapshotBlob->c_str();
+      snapshotBlob_->raw_size =
+          static_cast<int>(config_->snapshotBlob->size());
+      createParams.snapshot_blob = snapshotBlob_.get();
+    }
+    isolate_ = NewIsolate(createParams, jsQueue);
+  }
+  LogStartupMarker("isolateCreated");
 #if defined(__ANDROID__)
   if (!config_->timezoneId.empty()) {
     isolate_->DateTimeConfigurationChangeNotification(
@@ -70,11 +575,27 @@ V8Runtime::V8Runtime(
 #endif
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
+  isolate_->SetMicrotasksPolicy(
+      config_->enableExplicitMicrotasks ? v8::MicrotasksPolicy::kExplicit
+                                        : v8::MicrotasksPolicy::kAuto);
+  CreateWatchdogIfNeeded();
+  if (!config_->nearHeapLimitSnapshotPath.empty()) {
+    isolate_->AddNearHeapLimitCallback(NearHeapLimitCallback, this);
+  }
+  if (config_->enableGCTelemetry) {
+    gcTelemetry_ = std::make_unique<V8GCTelemetry>(
+        isolate_, config_->enableGCSystrace);
+  }
+  if (config_->enableCppgc) {
+    AttachCppHeap();
+  }
   v8::HandleScope scopedHandle(isolate_);
   context_.Reset(isolate_, CreateGlobalContext(isolate_));
   v8::Context::Scope scopedContext(context_.Get(isolate_));
+  LogStartupMarker("contextCreated");
   jsQueue_ = jsQueue;
-  if (config_->enableInspector) {
+  // Prewarmed runtimes connect the inspector in `AttachJSQueue()`
+  if (config_->enableInspector && jsQueue_) {
     inspectorClient_ = std::make_shared<InspectorClient>(
         jsQueue_,
         context_.Get(isolate_),
@@ -88,10 +609,27 @@ V8Runtime::V8Runtime(
     const V8Runtime *v8Runtime,
     std::unique_ptr<V8RuntimeConfig> config)
     : config_(std::move(config)) {
+  config_->codecacheMode = V8RuntimeConfig::CodecacheMode::kNone;
+  if (config_->enableDeferredFinalization) {
+    deferredFinalizer_ = std::make_unique<DeferredFinalizer>();
+  }
+
+  if (config_->enableSharedIsolate && v8Runtime->cppHeap_) {
+    // Wrappers on the parent's unified heap would reference this runtime
+    // after it is destroyed.
+    LOG(WARNING) << "[rnv8] Shared isolate is not supported with cppgc, "
+                    "creating a separate isolate instead.";
+    config_->enableSharedIsolate = false;
+  }
+  if (config_->enableSharedIsolate) {
+    InitializeWithSharedIsolate(v8Runtime);
+    return;
+  }
+
   arrayBufferAllocator_.reset(
       v8::ArrayBuffer::Allocator::NewDefaultAllocator());
   v8::Isolate::CreateParams createParams;
-  createParams.array_buffer_allocator = arrayBufferAllocator_.get();
+  createParams.array_buffer_allocator_shared = arrayBufferAllocator_;
   if (v8Runtime->config_->snapshotBlob) {
     snapshotBlob_ = std::make_unique<v8::StartupData>();
     snapshotBlob_->data = v8Runtime->config_->snapshotBlob->c_str();
@@ -99,9 +637,8 @@ V8Runtime::V8Runtime(
         static_cast<int>(v8Runtime->config_->snapshotBlob->size());
     createParams.snapshot_blob = snapshotBlob_.get();
   }
-  config_->codecacheMode = V8RuntimeConfig::CodecacheMode::kNone;
 
-  isolate_ = v8::Isolate::New(createParams);
+  isolate_ = NewIsolate(createParams, v8Runtime->jsQueue_);
 #if defined(__ANDROID__)
   if (!v8Runtime->config_->timezoneId.empty()) {
     isolate_->DateTimeConfigurationChangeNotification(
@@ -111,6 +648,20 @@ V8Runtime::V8Runtime(
 #endif
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
+  isolate_->SetMicrotasksPolicy(
+      config_->enableExplicitMicrotasks ? v8::MicrotasksPolicy::kExplicit
+                                        : v8::MicrotasksPolicy::kAuto);
+  CreateWatchdogIfNeeded();
+  if (!config_->nearHeapLimitSnapshotPath.empty()) {
+    isolate_->AddNearHeapLimitCallback(NearHeapLimitCallback, this);
+  }
+  if (config_->enableGCTelemetry) {
+    gcTelemetry_ = std::make_unique<V8GCTelemetry>(
+        isolate_, config_->enableGCSystrace);
+  }
+  if (config_->enableCppgc) {
+    AttachCppHeap();
+  }
   v8::HandleScope scopedHandle(isolate_);
   context_.Reset(isolate_, CreateGlobalContext(isolate_));
   v8::Context::Scope scopedContext(context_.Get(isolate_));
@@ -124,45 +675,52 @@ V8Runtime::V8Runtime(
         config_->deviceName);
     inspectorClient_->ConnectToReactFrontend();
   }
+}
 
-#if 0 // Experimental shared global context
+void V8Runtime::InitializeWithSharedIsolate(const V8Runtime *parentRuntime) {
   isSharedRuntime_ = true;
-  isolate_ = v8Runtime->isolate_;
-  jsQueue_ = v8Runtime->jsQueue_;
+  parentRuntime_ = parentRuntime;
+  ++parentRuntime_->sharedRuntimeCount_;
+  isolate_ = parentRuntime_->isolate_;
+  jsQueue_ = parentRuntime_->jsQueue_;
+  // The isolate level features stay owned by the parent
+  config_->enableCppgc = false;
+  config_->enableIsolateRecycling = false;
+  config_->watchdogTimeoutMs = 0;
+  config_->nearHeapLimitSnapshotPath.clear();
 
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
   context_.Reset(isolate_, CreateGlobalContext(isolate_));
 
-  auto localContext = context_.Get(isolate_);
-  localContext->SetSecurityToken(
-      v8Runtime->context_.Get(isolate_)->GetSecurityToken());
+  // Same security token so objects can be passed between the contexts
+  v8::Local<v8::Context> context = context_.Get(isolate_);
+  context->SetSecurityToken(
+      parentRuntime_->context_.Get(isolate_)->GetSecurityToken());
+  v8::Context::Scope scopedContext(context);
 
-  bool inheritProtoResult =
-      localContext->Global()
-          ->GetPrototype()
-          .As<v8::Object>()
-          ->SetPrototype(
-              localContext,
-              v8Runtime->context_.Get(isolate_)->Global()->GetPrototype())
-          .FromJust();
-  if (!inheritProtoResult) {
-    LOG(ERROR) << "Unable to inherit prototype from parent shared runtime.";
-  }
-
-  if (config_->enableInspector) {
+  if (config_->enableInspector && jsQueue_) {
     inspectorClient_ = std::make_shared<InspectorClient>(
-        jsQueue_,
-        context_.Get(isolate_),
-        config_->appName,
-        config_->deviceName);
+        jsQueue_, context, config_->appName, config_->deviceName);
     inspectorClient_->ConnectToReactFrontend();
   }
-#endif
+}
+
+void V8Runtime::CreateWatchdogIfNeeded() {
+  if (config_->watchdogTimeoutMs > 0) {
+    watchdog_ = std::make_shared<V8Watchdog>(
+        isolate_,
+        config_->watchdogTimeoutMs,
+        config_->watchdogTerminateExecution);
+  }
 }
 
 V8Runtime::~V8Runtime() {
+  selfRef_.reset();
+  watchdog_.reset();
+  bool recycleIsolate = config_->enableIsolateRecycling &&
+      !isSharedRuntime_ && sharedRuntimeCount_ == 0;
   {
     v8::Locker locker(isolate_);
     v8::Isolate::Scope scopedIsolate(isolate_);
@@ -170,28 +728,422 @@ V8Runtime::~V8Runtime() {
     if (inspectorClient_) {
       inspectorClient_.reset();
     }
+    timers_.reset();
+    if (!config_->nearHeapLimitSnapshotPath.empty()) {
+      isolate_->RemoveNearHeapLimitCallback(NearHeapLimitCallback, 0);
+    }
+    gcTelemetry_.reset();
+    runtimeInfoKeys_.reset();
+    if (cpuProfiler_) {
+      cpuProfiler_->Dispose();
+      cpuProfiler_ = nullptr;
+    }
 
+    for (auto &weakResolver : promiseResolvers_) {
+      if (auto resolver = weakResolver.lock()) {
+        resolver->Reset();
+      }
+    }
+    promiseResolvers_.clear();
     context_.Reset();
+
+    if (recycleIsolate || isSharedRuntime_) {
+      // Collect the old context now, so the weak callbacks referencing this
+      // runtime run before it goes away.
+      isolate_->ContextDisposedNotification();
+      isolate_->LowMemoryNotification();
+    } else {
+      recycledScripts_.clear();
+    }
+
+    if (cppHeap_) {
+      isolate_->DetachCppHeap();
+      cppHeap_->Terminate();
+      cppHeap_.reset();
+    }
+    ReleaseSweptPayloads();
   }
-  if (!isSharedRuntime_) {
-    isolate_->Dispose();
+  deferredFinalizer_.reset();
+  if (isSharedRuntime_) {
+    --parentRuntime_->sharedRuntimeCount_;
+  } else if (sharedRuntimeCount_ > 0) {
+    LOG(ERROR) << "[rnv8] Runtime destroyed before its " << sharedRuntimeCount_
+               << " shared runtimes, leaking the isolate.";
+  } else if (recycleIsolate) {
+    RecycleIsolate();
+  } else {
+    if (auto *platform = s_customPlatform) {
+      platform->UnregisterIsolate(isolate_);
+    }
+    if (config_->enableAsyncTeardown) {
+      IsolateDisposer::GetInstance().Dispose(
+          std::make_shared<DisposableIsolate>(
+              isolate_,
+              std::move(arrayBufferAllocator_),
+              std::move(snapshotBlob_),
+              std::move(config_)));
+    } else {
+      isolate_->Dispose();
+    }
   }
   // v8::V8::Dispose();
   // v8::V8::DisposePlatform();
 }
 
+void V8Runtime::RecycleIsolate() {
+  if (auto *platform = s_customPlatform) {
+    // Keep the foreground tasks until the next runtime attaches its JS queue
+    platform->AttachJSQueue(isolate_, nullptr);
+  }
+
+  auto recycledIsolate = std::make_unique<RecycledIsolate>();
+  recycledIsolate->isolate = isolate_;
+  recycledIsolate->arrayBufferAllocator = std::move(arrayBufferAllocator_);
+  recycledIsolate->snapshotBlob = std::move(snapshotBlob_);
+  recycledIsolate->snapshotBlobData = std::move(config_->snapshotBlob);
+  recycledIsolate->scripts = std::move(recycledScripts_);
+
+  std::unique_ptr<RecycledIsolate> replacedIsolate;
+  {
+    const std::lock_guard<std::mutex> lock(s_recycledIsolateMutex);
+    replacedIsolate = std::move(s_recycledIsolate);
+    s_recycledIsolate = std::move(recycledIsolate);
+  }
+}
+
+void V8Runtime::AttachJSQueue(
+    std::shared_ptr<facebook::react::MessageQueueThread> jsQueue) {
+  assert(!jsQueue_ && "The runtime already has a JS queue");
+  jsQueue_ = std::move(jsQueue);
+  if (auto *platform = s_customPlatform) {
+    platform->AttachJSQueue(isolate_, jsQueue_);
+  }
+
+  if (config_->enableInspector) {
+    v8::Locker locker(isolate_);
+    v8::Isolate::Scope scopedIsolate(isolate_);
+    v8::HandleScope scopedHandle(isolate_);
+    v8::Context::Scope scopedContext(context_.Get(isolate_));
+    inspectorClient_ = std::make_shared<InspectorClient>(
+        jsQueue_,
+        context_.Get(isolate_),
+        config_->appName,
+        config_->deviceName);
+    inspectorClient_->ConnectToReactFrontend();
+  }
+}
+
 void V8Runtime::OnMainLoopIdle() {
+  facebook::react::SystraceSection s("V8Runtime::OnMainLoopIdle");
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
   v8::Context::Scope scopedContext(context_.Get(isolate_));
 
   while (v8::platform::PumpMessageLoop(
-      s_platform.get(),
+      GetMessageLoopPlatform(),
       isolate_,
       v8::platform::MessageLoopBehavior::kDoNotWait)) {
     continue;
   }
+  ReleaseSweptPayloads();
+}
+
+std::pair<uint8_t *, size_t> V8Runtime::GetArrayBufferData(
+    const jsi::Object &object) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+
+  v8::Local<v8::Object> v8Object =
+      JSIV8ValueConverter::ToV8Object(*this, object);
+  if (v8Object->IsArrayBuffer()) {
+    v8::ArrayBuffer *v8ArrayBuffer = v8::ArrayBuffer::Cast(*v8Object);
+    return {
+        GetArrayBufferDataPointer(v8ArrayBuffer), v8ArrayBuffer->ByteLength()};
+  }
+  if (v8Object->IsSharedArrayBuffer()) {
+    v8::SharedArrayBuffer *v8SharedArrayBuffer =
+        v8::SharedArrayBuffer::Cast(*v8Object);
+#if V8_MAJOR_VERSION >= 10
+    uint8_t *data = reinterpret_cast<uint8_t *>(v8SharedArrayBuffer->Data());
+#else
+    uint8_t *data = reinterpret_cast<uint8_t *>(
+        v8SharedArrayBuffer->GetBackingStore()->Data());
+#endif
+    return {data, v8SharedArrayBuffer->ByteLength()};
+  }
+  if (v8Object->IsArrayBufferView()) {
+    v8::ArrayBufferView *v8View = v8::ArrayBufferView::Cast(*v8Object);
+    // `Buffer()` moves on-heap TypedArray contents to an off-heap store, so
+    // the returned pointer stays valid while the view is alive.
+    v8::Local<v8::ArrayBuffer> v8ArrayBuffer = v8View->Buffer();
+    uint8_t *data = GetArrayBufferDataPointer(*v8ArrayBuffer);
+    return {data ? data + v8View->ByteOffset() : nullptr, v8View->ByteLength()};
+  }
+  throw jsi::JSINativeException(
+      "GetArrayBufferData() - object is not an ArrayBuffer or a view");
+}
+
+size_t V8Runtime::GetPendingFinalizationCount() const {
+  return deferredFinalizer_ ? deferredFinalizer_->GetPendingCount() : 0;
+}
+
+jsi::Object V8Runtime::CreateTypedArray(
+    TypedArrayType type,
+    std::shared_ptr<jsi::MutableBuffer> buffer) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+  v8::Context::Scope scopedContext(context_.Get(isolate_));
+
+  v8::Local<v8::ArrayBuffer> v8ArrayBuffer =
+      CreateV8ArrayBuffer(std::move(buffer));
+  v8::Local<v8::TypedArray> v8TypedArray = CreateV8TypedArray(
+      type,
+      v8ArrayBuffer,
+      0,
+      v8ArrayBuffer->ByteLength() / GetTypedArrayElementSize(type));
+  return make<jsi::Object>(new V8PointerValue(isolate_, v8TypedArray));
+}
+
+jsi::Object V8Runtime::CreateTypedArray(
+    TypedArrayType type,
+    const jsi::ArrayBuffer &arrayBuffer,
+    size_t byteOffset,
+    size_t length) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+  v8::Context::Scope scopedContext(context_.Get(isolate_));
+
+  v8::Local<v8::Object> v8Object =
+      JSIV8ValueConverter::ToV8Object(*this, arrayBuffer);
+  assert(v8Object->IsArrayBuffer());
+  v8::Local<v8::TypedArray> v8TypedArray = CreateV8TypedArray(
+      type, v8Object.As<v8::ArrayBuffer>(), byteOffset, length);
+  return make<jsi::Object>(new V8PointerValue(isolate_, v8TypedArray));
+}
+
+std::pair<jsi::Value, std::shared_ptr<V8PromiseResolver>>
+V8Runtime::CreatePromise() {
+  if (!jsQueue_) {
+    throw jsi::JSINativeException("CreatePromise() requires a JS queue");
+  }
+
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+  v8::Local<v8::Context> context = context_.Get(isolate_);
+  v8::Context::Scope scopedContext(context);
+
+  v8::Local<v8::Promise::Resolver> resolver =
+      v8::Promise::Resolver::New(context).ToLocalChecked();
+  return std::make_pair(
+      JSIV8ValueConverter::ToJSIValue(isolate_, resolver->GetPromise()),
+      std::make_shared<V8PromiseResolver>(*this, resolver));
+}
+
+void V8Runtime::StartCpuProfiler(int samplingIntervalUs) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+
+  if (cpuProfiler_) {
+    return;
+  }
+  cpuProfiler_ = v8::CpuProfiler::New(isolate_);
+  if (samplingIntervalUs > 0) {
+    cpuProfiler_->SetSamplingInterval(samplingIntervalUs);
+  }
+  // Samples are needed for the timeline view in DevTools
+  cpuProfiler_->StartProfiling(
+      v8::String::NewFromUtf8Literal(isolate_, kCpuProfileTitle),
+      v8::kLeafNodeLineNumbers,
+      true);
+}
+
+bool V8Runtime::StopCpuProfiler(const std::string &filename) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+
+  if (!cpuProfiler_) {
+    return false;
+  }
+  v8::CpuProfile *profile = cpuProfiler_->StopProfiling(
+      v8::String::NewFromUtf8Literal(isolate_, kCpuProfileTitle));
+  bool result = false;
+  if (profile) {
+    result = V8ProfileSerializer::WriteCpuProfile(*profile, filename);
+    profile->Delete();
+  }
+  cpuProfiler_->Dispose();
+  cpuProfiler_ = nullptr;
+  if (!result) {
+    LOG(ERROR) << "[rnv8] Cannot write CPU profile: " << filename;
+  }
+  return result;
+}
+
+void V8Runtime::StartHeapSamplingProfiler(uint64_t samplingIntervalBytes) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+
+  v8::HeapProfiler *heapProfiler = isolate_->GetHeapProfiler();
+  if (samplingIntervalBytes > 0) {
+    heapProfiler->StartSamplingHeapProfiler(samplingIntervalBytes);
+  } else {
+    heapProfiler->StartSamplingHeapProfiler();
+  }
+}
+
+bool V8Runtime::StopHeapSamplingProfiler(const std::string &filename) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+
+  v8::HeapProfiler *heapProfiler = isolate_->GetHeapProfiler();
+  std::unique_ptr<v8::AllocationProfile> profile(
+      heapProfiler->GetAllocationProfile());
+  if (!profile) {
+    return false;
+  }
+  bool result = V8ProfileSerializer::WriteSamplingHeapProfile(
+      isolate_, *profile, filename);
+  profile.reset();
+  heapProfiler->StopSamplingHeapProfiler();
+  if (!result) {
+    LOG(ERROR) << "[rnv8] Cannot write heap profile: " << filename;
+  }
+  return result;
+}
+
+bool V8Runtime::WriteHeapSnapshot(const std::string &filename) {
+  // Lockers nest, so this is also safe from NearHeapLimitCallback
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+
+  v8::HeapProfiler *heapProfiler = isolate_->GetHeapProfiler();
+  const v8::HeapSnapshot *snapshot = heapProfiler->TakeHeapSnapshot();
+  if (!snapshot) {
+    return false;
+  }
+  bool result = V8ProfileSerializer::WriteHeapSnapshot(*snapshot, filename);
+  const_cast<v8::HeapSnapshot *>(snapshot)->Delete();
+  if (!result) {
+    LOG(ERROR) << "[rnv8] Cannot write heap snapshot: " << filename;
+  }
+  return result;
+}
+
+std::optional<V8GCStats> V8Runtime::GetGCStats() const {
+  if (!gcTelemetry_) {
+    return std::nullopt;
+  }
+  return gcTelemetry_->GetStats();
+}
+
+const std::vector<std::pair<const char *, double>> &
+V8Runtime::GetStartupMarkers() const {
+  return startupMarkers_;
+}
+
+const V8CodeCacheStats &V8Runtime::GetCodeCacheStats() const {
+  return codeCacheStats_;
+}
+
+V8HeapInfo V8Runtime::GetHeapInfo(bool includeCodeStatistics) {
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+
+  V8HeapInfo info;
+  v8::HeapStatistics heapStats;
+  isolate_->GetHeapStatistics(&heapStats);
+  info.heapSizeLimit = heapStats.heap_size_limit();
+  info.totalHeapSize = heapStats.total_heap_size();
+  info.usedHeapSize = heapStats.used_heap_size();
+  info.totalAvailableSize = heapStats.total_available_size();
+  info.totalPhysicalSize = heapStats.total_physical_size();
+  info.externalMemory = heapStats.external_memory();
+  info.mallocedMemory = heapStats.malloced_memory();
+  info.peakMallocedMemory = heapStats.peak_malloced_memory();
+  info.globalHandlesSize = heapStats.total_global_handles_size();
+  info.usedGlobalHandlesSize = heapStats.used_global_handles_size();
+  info.nativeContexts = heapStats.number_of_native_contexts();
+  info.detachedContexts = heapStats.number_of_detached_contexts();
+
+  v8::HeapCodeStatistics codeStats;
+  if (includeCodeStatistics &&
+      isolate_->GetHeapCodeAndMetadataStatistics(&codeStats)) {
+    V8HeapCodeInfo &code = info.code.emplace();
+    code.codeAndMetadataSize = codeStats.code_and_metadata_size();
+    code.bytecodeAndMetadataSize = codeStats.bytecode_and_metadata_size();
+    code.externalScriptSourceSize = codeStats.external_script_source_size();
+    code.cpuProfilerMetadataSize = codeStats.cpu_profiler_metadata_size();
+  }
+
+  size_t spaceCount = isolate_->NumberOfHeapSpaces();
+  info.spaces.reserve(spaceCount);
+  for (size_t i = 0; i < spaceCount; ++i) {
+    v8::HeapSpaceStatistics spaceStats;
+    if (!isolate_->GetHeapSpaceStatistics(&spaceStats, i)) {
+      continue;
+    }
+    info.spaces.push_back(
+        {spaceStats.space_name(),
+         spaceStats.space_size(),
+         spaceStats.space_used_size(),
+         spaceStats.space_available_size(),
+         spaceStats.physical_space_size()});
+  }
+
+  info.livePointerValues = V8PointerValue::GetLiveCount();
+  info.liveHostObjects = HostObjectProxy::GetLiveCount();
+  info.liveNativeStates = NativeStateProxy::GetLiveCount();
+  return info;
+}
+
+void V8Runtime::AddCodeCacheRecord(V8CodeCacheRecord &&record) {
+  switch (record.result) {
+    case V8CodeCacheResult::kDisabled:
+      break;
+    case V8CodeCacheResult::kMiss:
+      ++codeCacheStats_.missCount;
+      break;
+    case V8CodeCacheResult::kHit:
+      ++codeCacheStats_.hitCount;
+      break;
+    case V8CodeCacheResult::kRejected:
+      ++codeCacheStats_.rejectedCount;
+      break;
+    case V8CodeCacheResult::kRecycled:
+      ++codeCacheStats_.recycledCount;
+      break;
+  }
+  auto &records = codeCacheStats_.records;
+  if (records.size() >= V8CodeCacheStats::kMaxRecords) {
+    records.erase(records.begin());
+  }
+  records.push_back(std::move(record));
+}
+
+void V8Runtime::LogStartupMarker(const char *name) {
+  for (const auto &marker : startupMarkers_) {
+    if (std::strcmp(marker.first, name) == 0) {
+      return;
+    }
+  }
+  {
+    // An empty section marks the point in the trace
+    facebook::react::SystraceSection s(name);
+  }
+  startupMarkers_.emplace_back(
+      name,
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - createdTime_)
+          .count());
 }
 
 v8::Local<v8::Context> V8Runtime::CreateGlobalContext(v8::Isolate *isolate) {
@@ -200,7 +1152,14 @@ v8::Local<v8::Context> V8Runtime::CreateGlobalContext(v8::Isolate *isolate) {
   global->Set(
       v8::String::NewFromUtf8(isolate, "_v8runtime", v8::NewStringType::kNormal)
           .ToLocalChecked(),
-      v8::FunctionTemplate::New(isolate, V8Runtime::GetRuntimeInfo));
+      v8::FunctionTemplate::New(
+          isolate,
+          V8Runtime::GetRuntimeInfo,
+          v8::External::New(isolate, this)));
+  if (config_->enableNativeTimers) {
+    timers_ = std::make_shared<V8Timers>(*this);
+    timers_->InstallGlobals(isolate, global);
+  }
   return v8::Context::New(isolate_, nullptr, global);
 }
 
@@ -220,44 +1179,116 @@ jsi::Value V8Runtime::ExecuteScript(
 
   v8::Local<v8::Context> context(isolate->GetCurrentContext());
 
-  auto codecache = LoadCodeCacheIfNeeded(sourceURL);
-  v8::ScriptCompiler::CachedData *cachedData = codecache.release();
+  V8CodeCacheRecord codeCacheRecord;
+  codeCacheRecord.sourceURL = sourceURL;
+  v8::Local<v8::Script> compiledScript =
+      BindRecycledScript(isolate, script, sourceURL);
+  if (!compiledScript.IsEmpty()) {
+    codeCacheRecord.result = V8CodeCacheResult::kRecycled;
+  } else {
+    auto codecache = LoadCodeCacheIfNeeded(sourceURL, codeCacheRecord);
+    v8::ScriptCompiler::CachedData *cachedData = codecache.release();
+    if (cachedData) {
+      LogStartupMarker("codeCacheLoaded");
+    }
 
-  std::unique_ptr<v8::ScriptCompiler::Source> source =
-      UseFakeSourceIfNeeded(origin, cachedData);
-  if (!source) {
-    source = std::make_unique<v8::ScriptCompiler::Source>(
-        script, origin, cachedData);
-  }
+    std::unique_ptr<v8::ScriptCompiler::Source> source =
+        UseFakeSourceIfNeeded(origin, cachedData);
+    if (!source) {
+      source = std::make_unique<v8::ScriptCompiler::Source>(
+          script, origin, cachedData);
+    }
 
-  v8::Local<v8::Script> compiledScript;
-  if (!v8::ScriptCompiler::Compile(
-           context,
-           source.release(),
-           cachedData ? v8::ScriptCompiler::kConsumeCodeCache
-                      : v8::ScriptCompiler::kNoCompileOptions)
-           .ToLocal(&compiledScript)) {
-    ReportException(isolate, &tryCatch);
-    return {};
-  }
+    auto compileStart = std::chrono::steady_clock::now();
+    {
+      facebook::react::SystraceSection s(
+          "V8Runtime::Compile", "sourceURL", sourceURL);
+      if (!v8::ScriptCompiler::Compile(
+               context,
+               source.release(),
+               cachedData ? v8::ScriptCompiler::kConsumeCodeCache
+                          : v8::ScriptCompiler::kNoCompileOptions)
+               .ToLocal(&compiledScript)) {
+        ReportException(isolate, &tryCatch);
+        return {};
+      }
+    }
+    codeCacheRecord.compileMs = ElapsedMs(compileStart);
+    LogStartupMarker("scriptCompiled");
 
-  if (cachedData && cachedData->rejected) {
-    LOG(INFO) << "[rnv8] cache miss: " << sourceURL;
+    if (cachedData) {
+      codeCacheRecord.result = cachedData->rejected
+          ? V8CodeCacheResult::kRejected
+          : V8CodeCacheResult::kHit;
+    }
+    SaveCodeCacheIfNeeded(
+        compiledScript, sourceURL, cachedData, codeCacheRecord);
+    if (codeCacheRecord.result == V8CodeCacheResult::kRejected) {
+      LOG(INFO) << "[rnv8] cache rejected ("
+                << ToString(codeCacheRecord.rejectReason)
+                << "): " << sourceURL;
+    }
+    RetainScriptIfNeeded(isolate, compiledScript, script, sourceURL);
   }
-  SaveCodeCacheIfNeeded(compiledScript, sourceURL, cachedData);
+  AddCodeCacheRecord(std::move(codeCacheRecord));
 
   v8::Local<v8::Value> result;
-  if (!compiledScript->Run(context).ToLocal(&result)) {
-    assert(tryCatch.HasCaught());
-    ReportException(isolate, &tryCatch);
-    return {};
+  {
+    facebook::react::SystraceSection s(
+        "V8Runtime::Run", "sourceURL", sourceURL);
+    if (!compiledScript->Run(context).ToLocal(&result)) {
+      assert(tryCatch.HasCaught());
+      ReportException(isolate, &tryCatch);
+      return {};
+    }
   }
+  LogStartupMarker("scriptRun");
 
   return JSIV8ValueConverter::ToJSIValue(isolate, result);
 }
 
+v8::Local<v8::Script> V8Runtime::BindRecycledScript(
+    v8::Isolate *isolate,
+    const v8::Local<v8::String> &source,
+    const std::string &sourceURL) {
+  auto it = recycledScripts_.find(sourceURL);
+  if (it == recycledScripts_.end()) {
+    return {};
+  }
+  if (!it->second.source.Get(isolate)->StringEquals(source)) {
+    recycledScripts_.erase(it);
+    return {};
+  }
+  return it->second.script.Get(isolate)->BindToCurrentContext();
+}
+
+void V8Runtime::RetainScriptIfNeeded(
+    v8::Isolate *isolate,
+    const v8::Local<v8::Script> &script,
+    const v8::Local<v8::String> &source,
+    const std::string &sourceURL) {
+  if (!config_->enableIsolateRecycling) {
+    return;
+  }
+  RecycledScript &recycledScript = recycledScripts_[sourceURL];
+  recycledScript.source.Reset(isolate, source);
+  recycledScript.script.Reset(isolate, script->GetUnboundScript());
+}
+
 void V8Runtime::ReportException(v8::Isolate *isolate, v8::TryCatch *tryCatch)
     const {
+  if (tryCatch->HasTerminated()) {
+    if (watchdog_ && watchdog_->CancelTerminationIfNeeded()) {
+      throw jsi::JSError(
+          const_cast<V8Runtime &>(*this),
+          "JS execution exceeded the watchdog timeout of " +
+              std::to_string(watchdog_->GetTimeoutMs()) + "ms");
+    }
+    // No JS can run until the termination unwinds to the outermost call,
+    // including the Error constructor used by jsi::JSError.
+    throw jsi::JSINativeException("JS execution terminated");
+  }
+
   v8::HandleScope scopedHandle(isolate);
   std::string exception =
       JSIV8ValueConverter::ToSTLString(isolate, tryCatch->Exception());
@@ -306,8 +1337,68 @@ void V8Runtime::ReportException(v8::Isolate *isolate, v8::TryCatch *tryCatch)
   }
 }
 
+v8::Local<v8::ArrayBuffer> V8Runtime::CreateV8ArrayBuffer(
+    std::shared_ptr<jsi::MutableBuffer> buffer) {
+  v8::EscapableHandleScope scopedHandle(isolate_);
+
+  // Wrap the MutableBuffer memory without copying. The shared_ptr is kept on
+  // the C++ heap and released by the deleter once V8 frees the backing store.
+  // V8 accounts the backing store length as external memory of the
+  // ArrayBuffer, so the GC sees the native payload size.
+  void *data = buffer->data();
+  size_t size = buffer->size();
+  auto *bufferPtr = new std::shared_ptr<jsi::MutableBuffer>(std::move(buffer));
+  std::unique_ptr<v8::BackingStore> backingStore =
+      v8::ArrayBuffer::NewBackingStore(
+          data,
+          size,
+          [](void *data, size_t length, void *deleterData) {
+            delete reinterpret_cast<std::shared_ptr<jsi::MutableBuffer> *>(
+                deleterData);
+          },
+          bufferPtr);
+  return scopedHandle.Escape(
+      v8::ArrayBuffer::New(isolate_, std::move(backingStore)));
+}
+
+v8::Local<v8::TypedArray> V8Runtime::CreateV8TypedArray(
+    TypedArrayType type,
+    v8::Local<v8::ArrayBuffer> arrayBuffer,
+    size_t byteOffset,
+    size_t length) {
+  v8::EscapableHandleScope scopedHandle(isolate_);
+
+  size_t elementSize = GetTypedArrayElementSize(type);
+  // V8 aborts on misaligned or out-of-range views, so validate them here.
+  if (elementSize == 0 || byteOffset % elementSize != 0 ||
+      byteOffset > arrayBuffer->ByteLength() ||
+      length > (arrayBuffer->ByteLength() - byteOffset) / elementSize) {
+    throw jsi::JSINativeException(
+        "CreateTypedArray() - invalid byteOffset or length");
+  }
+
+  v8::Local<v8::TypedArray> typedArray;
+  switch (type) {
+    case TypedArrayType::kUint8:
+      typedArray = v8::Uint8Array::New(arrayBuffer, byteOffset, length);
+      break;
+    case TypedArrayType::kInt32:
+      typedArray = v8::Int32Array::New(arrayBuffer, byteOffset, length);
+      break;
+    case TypedArrayType::kFloat32:
+      typedArray = v8::Float32Array::New(arrayBuffer, byteOffset, length);
+      break;
+    case TypedArrayType::kFloat64:
+      typedArray = v8::Float64Array::New(arrayBuffer, byteOffset, length);
+      break;
+  }
+  return scopedHandle.Escape(typedArray);
+}
+
 std::unique_ptr<v8::ScriptCompiler::CachedData>
-V8Runtime::LoadCodeCacheIfNeeded(const std::string &sourceURL) {
+V8Runtime::LoadCodeCacheIfNeeded(
+    const std::string &sourceURL,
+    V8CodeCacheRecord &record) {
   // caching is for main runtime only
   if (isSharedRuntime_) {
     return nullptr;
@@ -317,6 +1408,10 @@ V8Runtime::LoadCodeCacheIfNeeded(const std::string &sourceURL) {
     return nullptr;
   }
 
+  facebook::react::SystraceSection s("V8Runtime::LoadCodeCacheIfNeeded");
+  auto start = std::chrono::steady_clock::now();
+  record.result = V8CodeCacheResult::kMiss;
+
   std::filesystem::path codecachePath(config_->codecacheDir);
   codecachePath /= std::filesystem::path(sourceURL).filename();
   auto *file = std::fopen(codecachePath.string().c_str(), "rb");
@@ -331,6 +1426,8 @@ V8Runtime::LoadCodeCacheIfNeeded(const std::string &sourceURL) {
 
   std::fread(buffer, size, 1, file);
   std::fclose(file);
+  record.fileSize = size;
+  record.loadMs = ElapsedMs(start);
 
   return std::make_unique<v8::ScriptCompiler::CachedData>(
       buffer,
@@ -341,7 +1438,8 @@ V8Runtime::LoadCodeCacheIfNeeded(const std::string &sourceURL) {
 bool V8Runtime::SaveCodeCacheIfNeeded(
     const v8::Local<v8::Script> &script,
     const std::string &sourceURL,
-    v8::ScriptCompiler::CachedData *cachedData) {
+    v8::ScriptCompiler::CachedData *cachedData,
+    V8CodeCacheRecord &record) {
   // caching is for main runtime only
   if (isSharedRuntime_) {
     return false;
@@ -355,20 +1453,31 @@ bool V8Runtime::SaveCodeCacheIfNeeded(
     return false;
   }
 
+  facebook::react::SystraceSection s("V8Runtime::SaveCodeCacheIfNeeded");
+  auto start = std::chrono::steady_clock::now();
   v8::HandleScope scopedHandle(isolate_);
 
   v8::Local<v8::UnboundScript> unboundScript = script->GetUnboundScript();
   std::unique_ptr<v8::ScriptCompiler::CachedData> newCachedData;
   newCachedData.reset(v8::ScriptCompiler::CreateCodeCache(unboundScript));
   if (!newCachedData) {
+    if (cachedData) {
+      record.rejectReason = V8CodeCacheRejectReason::kUnknown;
+    }
     return false;
   }
+  if (cachedData) {
+    record.rejectReason =
+        GetCodeCacheRejectReason(*cachedData, *newCachedData);
+  }
 
   std::filesystem::path codecachePath(config_->codecacheDir);
   codecachePath /= std::filesystem::path(sourceURL).filename();
   if (auto *file = std::fopen(codecachePath.string().c_str(), "wb")) {
     std::fwrite(newCachedData->data, 1, newCachedData->length, file);
     std::fclose(file);
+    record.saveMs = ElapsedMs(start);
+    record.savedSize = newCachedData->length;
     return true;
   } else {
     LOG(ERROR) << "Cannot save codecache file: " << codecachePath.string();
@@ -408,27 +1517,119 @@ V8Runtime::InternalFieldType V8Runtime::GetInternalFieldType(
   if (object->InternalFieldCount() != 2) {
     return V8Runtime::InternalFieldType::kInvalid;
   }
+  if (cppHeap_) {
+    auto *typeInfo = reinterpret_cast<const WrapperTypeInfo *>(
+        object->GetAlignedPointerFromInternalField(0));
+    if (!typeInfo || typeInfo->embedderId != kEmbedderId) {
+      return V8Runtime::InternalFieldType::kInvalid;
+    }
+    return static_cast<V8Runtime::InternalFieldType>(
+        typeInfo->internalFieldType);
+  }
   v8::Local<v8::Value> typeValue = object->GetInternalField(0);
   assert(typeValue->IsUint32());
   return static_cast<V8Runtime::InternalFieldType>(
       v8::Local<v8::Uint32>::Cast(typeValue)->Value());
 }
 
+void V8Runtime::AttachCppHeap() {
+  cppHeap_ = v8::CppHeap::Create(
+      GetPlatform(),
+      v8::CppHeapCreateParams(
+          {},
+          v8::WrapperDescriptor(
+              0 /* wrappable_type_index */,
+              1 /* wrappable_instance_index */,
+              kEmbedderId)));
+  isolate_->AttachCppHeap(cppHeap_.get());
+}
+
+void V8Runtime::SetWrapperInternalFields(
+    v8::Local<v8::Object> object,
+    InternalFieldType type,
+    void *wrappable) {
+  static const WrapperTypeInfo kWrapperTypeInfos[] = {
+      {kEmbedderId, InternalFieldType::kInvalid},
+      {kEmbedderId, InternalFieldType::kHostObject},
+      {kEmbedderId, InternalFieldType::kNativeState},
+  };
+  static_assert(
+      sizeof(kWrapperTypeInfos) / sizeof(kWrapperTypeInfos[0]) ==
+      InternalFieldType::kMaxValue + 1);
+
+  int indices[] = {0, 1};
+  void *values[] = {
+      const_cast<WrapperTypeInfo *>(&kWrapperTypeInfos[type]), wrappable};
+  // Setting both fields at once also emits the unified heap write barrier
+  object->SetAlignedPointerInInternalFields(2, indices, values);
+}
+
+void V8Runtime::ReleaseSweptPayload(std::shared_ptr<void> payload) {
+  // Unified heap finalizers run while sweeping, where releasing jsi values
+  // held by the payload must not call back into V8. Defer the release to the
+  // next idle slot or microtask drain, or until `cppHeap_->Terminate()`
+  // returns in the destructor.
+  if (deferredFinalizer_) {
+    deferredFinalizer_->Release(std::move(payload));
+  } else {
+    std::lock_guard<std::mutex> lock(sweptPayloadsMutex_);
+    sweptPayloads_.push_back(std::move(payload));
+  }
+}
+
+void V8Runtime::ReleaseSweptPayloads() {
+  std::vector<std::shared_ptr<void>> payloads;
+  {
+    std::lock_guard<std::mutex> lock(sweptPayloadsMutex_);
+    payloads.swap(sweptPayloads_);
+  }
+  payloads.clear();
+  if (deferredFinalizer_) {
+    deferredFinalizer_->Drain();
+  }
+}
+
 // static
 v8::Platform *V8Runtime::GetPlatform() {
   return s_platform.get();
 }
 
+// static
+v8::Platform *V8Runtime::GetMessageLoopPlatform() {
+  // PumpMessageLoop() only accepts the default platform, which still owns the
+  // tasks of isolates without a JS queue.
+  if (auto *platform = s_customPlatform) {
+    return platform->GetDefaultPlatform();
+  }
+  return s_platform.get();
+}
+
+// static
+v8::Isolate *V8Runtime::NewIsolate(
+    const v8::Isolate::CreateParams &createParams,
+    const std::shared_ptr<facebook::react::MessageQueueThread> &jsQueue) {
+  v8::Isolate *isolate = v8::Isolate::Allocate();
+  // The heap caches its foreground task runner during initialization, so the
+  // JS queue must be registered before that.
+  if (auto *platform = s_customPlatform) {
+    platform->RegisterIsolate(isolate, jsQueue);
+  }
+  v8::Isolate::Initialize(isolate, createParams);
+  return isolate;
+}
+
 //
 // jsi::Runtime implementations
 //
 jsi::Value V8Runtime::evaluateJavaScript(
     const std::shared_ptr<const jsi::Buffer> &buffer,
     const std::string &sourceURL) {
+  RNV8_INSTRUMENT_JSI(kEvaluateJavaScript);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
   v8::Context::Scope scopedContext(context_.Get(isolate_));
+  V8Watchdog::Scope scopedWatchdog(watchdog_.get());
   v8::Local<v8::String> string;
   if (JSIV8ValueConverter::ToV8String(*this, buffer).ToLocal(&string)) {
     return ExecuteScript(isolate_, string, sourceURL);
@@ -456,25 +1657,42 @@ jsi::Value V8Runtime::evaluatePreparedJavaScript(
 #if REACT_NATIVE_MINOR_VERSION >= 75 || \
     (REACT_NATIVE_MINOR_VERSION >= 74 && REACT_NATIVE_PATCH_VERSION >= 3)
 void V8Runtime::queueMicrotask(const jsi::Function &callback) {
-  // TODO: add this when we revisit new architecture support
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+  v8::Context::Scope scopedContext(context_.Get(isolate_));
+
+  isolate_->EnqueueMicrotask(
+      JSIV8ValueConverter::ToV8Function(*this, callback));
 }
 #endif // REACT_NATIVE_MINOR_VERSION >= 75 || (REACT_NATIVE_MINOR_VERSION >= 74
        // && REACT_NATIVE_PATCH_VERSION >= 3
 
 bool V8Runtime::drainMicrotasks(int maxMicrotasksHint) {
+  facebook::react::SystraceSection s("V8Runtime::drainMicrotasks");
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
   v8::Context::Scope scopedContext(context_.Get(isolate_));
 
-  while (v8::platform::PumpMessageLoop(
-      s_platform.get(),
-      isolate_,
-      v8::platform::MessageLoopBehavior::kDoNotWait)) {
-    continue;
+  // Platform tasks, e.g. promise resolutions posted by background
+  // compilation, are skipped when the caller asks for no work at all
+  if (maxMicrotasksHint != 0) {
+    while (v8::platform::PumpMessageLoop(
+        GetMessageLoopPlatform(),
+        isolate_,
+        v8::platform::MessageLoopBehavior::kDoNotWait)) {
+      continue;
+    }
   }
   isolate_->PerformMicrotaskCheckpoint();
-  return true;
+  ReleaseSweptPayloads();
+  // The checkpoint runs until the queue is empty, unless it is nested in a
+  // running checkpoint or execution was terminated
+  v8::MicrotaskQueue *microtaskQueue =
+      context_.Get(isolate_)->GetMicrotaskQueue();
+  return !isolate_->IsExecutionTerminating() &&
+      !(microtaskQueue && microtaskQueue->IsRunningMicrotasks());
 }
 
 jsi::Object V8Runtime::global() {
@@ -575,6 +1793,7 @@ jsi::Runtime::PointerValue *V8Runtime::clonePropNameID(
 jsi::PropNameID V8Runtime::createPropNameIDFromAscii(
     const char *str,
     size_t length) {
+  RNV8_INSTRUMENT_JSI(kCreatePropNameIDFromAscii);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -591,6 +1810,7 @@ jsi::PropNameID V8Runtime::createPropNameIDFromAscii(
 jsi::PropNameID V8Runtime::createPropNameIDFromUtf8(
     const uint8_t *utf8,
     size_t length) {
+  RNV8_INSTRUMENT_JSI(kCreatePropNameIDFromUtf8);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -637,6 +1857,7 @@ jsi::PropNameID V8Runtime::createPropNameIDFromSymbol(
 #endif
 
 std::string V8Runtime::utf8(const jsi::PropNameID &sym) {
+  RNV8_INSTRUMENT_JSI(kUtf8);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -780,6 +2001,7 @@ jsi::String V8Runtime::bigintToString(const jsi::BigInt &value, int radix) {
 }
 
 jsi::String V8Runtime::createStringFromAscii(const char *str, size_t length) {
+  RNV8_INSTRUMENT_JSI(kCreateStringFromAscii);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -795,6 +2017,7 @@ jsi::String V8Runtime::createStringFromAscii(const char *str, size_t length) {
 }
 
 jsi::String V8Runtime::createStringFromUtf8(const uint8_t *str, size_t length) {
+  RNV8_INSTRUMENT_JSI(kCreateStringFromUtf8);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -809,6 +2032,7 @@ jsi::String V8Runtime::createStringFromUtf8(const uint8_t *str, size_t length) {
 }
 
 std::string V8Runtime::utf8(const jsi::String &str) {
+  RNV8_INSTRUMENT_JSI(kUtf8);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -823,6 +2047,7 @@ std::string V8Runtime::utf8(const jsi::String &str) {
 }
 
 jsi::Object V8Runtime::createObject() {
+  RNV8_INSTRUMENT_JSI(kCreateObject);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -834,6 +2059,7 @@ jsi::Object V8Runtime::createObject() {
 
 jsi::Object V8Runtime::createObject(
     std::shared_ptr<jsi::HostObject> hostObject) {
+  RNV8_INSTRUMENT_JSI(kCreateObject);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -859,13 +2085,21 @@ jsi::Object V8Runtime::createObject(
     throw jsi::JSError(*this, "Unable to create HostObject");
   }
 
-  v8::Local<v8::External> wrappedHostObjectProxy =
-      v8::External::New(isolate_, hostObjectProxy);
-  v8Object->SetInternalField(
-      0,
-      v8::Integer::NewFromUnsigned(isolate_, InternalFieldType::kHostObject));
-  v8Object->SetInternalField(1, wrappedHostObjectProxy);
-  hostObjectProxy->BindFinalizer(v8Object);
+  if (cppHeap_) {
+    SetWrapperInternalFields(
+        v8Object,
+        InternalFieldType::kHostObject,
+        cppgc::MakeGarbageCollected<ProxyWrappable<HostObjectProxy>>(
+            cppHeap_->GetAllocationHandle(), hostObjectProxy));
+  } else {
+    v8::Local<v8::External> wrappedHostObjectProxy =
+        v8::External::New(isolate_, hostObjectProxy);
+    v8Object->SetInternalField(
+        0,
+        v8::Integer::NewFromUnsigned(isolate_, InternalFieldType::kHostObject));
+    v8Object->SetInternalField(1, wrappedHostObjectProxy);
+    hostObjectProxy->BindFinalizer(v8Object);
+  }
 
   return make<jsi::Object>(new V8PointerValue(isolate_, v8Object));
 }
@@ -883,10 +2117,8 @@ std::shared_ptr<jsi::HostObject> V8Runtime::getHostObject(
 
   v8::Local<v8::Object> v8Object =
       JSIV8ValueConverter::ToV8Object(*this, object);
-  v8::Local<v8::External> internalField =
-      v8::Local<v8::External>::Cast(v8Object->GetInternalField(1));
   HostObjectProxy *hostObjectProxy =
-      reinterpret_cast<HostObjectProxy *>(internalField->Value());
+      HostObjectProxy::FromObject(isolate_, v8Object);
   assert(hostObjectProxy);
   return hostObjectProxy->GetHostObject();
 }
@@ -948,9 +2180,10 @@ std::shared_ptr<jsi::NativeState> V8Runtime::getNativeState(
 
   v8::Local<v8::Object> v8Object =
       JSIV8ValueConverter::ToV8Object(*this, object);
-  auto *nativeStatePtr = reinterpret_cast<std::shared_ptr<jsi::NativeState> *>(
-      v8Object->GetAlignedPointerFromInternalField(1));
-  return std::shared_ptr(*nativeStatePtr);
+  NativeStateProxy *nativeStateProxy =
+      NativeStateProxy::FromObject(isolate_, v8Object);
+  assert(nativeStateProxy);
+  return nativeStateProxy->GetNativeState();
 }
 
 void V8Runtime::setNativeState(
@@ -980,14 +2213,22 @@ void V8Runtime::setNativeState(
       const_cast<Runtime::PointerValue *>(getPointerValue(object)));
   v8PointerValue->Reset(isolate_, v8Object);
 
-  v8Object->SetInternalField(
-      0,
-      v8::Integer::NewFromUnsigned(isolate_, InternalFieldType::kNativeState));
-  // Allocate a shared_ptr on the C++ heap and use it as context of NativeState.
-  auto *nativeStatePtr =
-      new std::shared_ptr<jsi::NativeState>(std::move(state));
-  v8Object->SetAlignedPointerInInternalField(
-      1, reinterpret_cast<void *>(nativeStatePtr));
+  NativeStateProxy *nativeStateProxy =
+      new NativeStateProxy(*this, isolate_, std::move(state));
+  if (cppHeap_) {
+    SetWrapperInternalFields(
+        v8Object,
+        InternalFieldType::kNativeState,
+        cppgc::MakeGarbageCollected<ProxyWrappable<NativeStateProxy>>(
+            cppHeap_->GetAllocationHandle(), nativeStateProxy));
+  } else {
+    v8Object->SetInternalField(
+        0,
+        v8::Integer::NewFromUnsigned(
+            isolate_, InternalFieldType::kNativeState));
+    v8Object->SetAlignedPointerInInternalField(
+        1, reinterpret_cast<void *>(nativeStateProxy));
+  }
 
   // Clone properties to the new object created from object template with
   // two internal fields.
@@ -1009,23 +2250,17 @@ void V8Runtime::setNativeState(
       ->Call(isolate_->GetCurrentContext(), v8::Undefined(isolate_), 2, args)
       .ToLocalChecked();
 
-  // Bind a global handle with weak callback to cleanup the shared_ptr
-  // on the C++ heap.
-  v8::Global<v8::Object> weakV8Object(isolate_, v8Object);
-  weakV8Object.SetWeak(
-      &weakV8Object,
-      [](const v8::WeakCallbackInfo<v8::Global<v8::Object>> &data) {
-        v8::Global<v8::Object> *weakV8ObjectPtr = data.GetParameter();
-        weakV8ObjectPtr->Reset();
-        delete reinterpret_cast<std::shared_ptr<jsi::NativeState> *>(
-            data.GetInternalField(1));
-      },
-      v8::WeakCallbackType::kInternalFields);
+  // Bind a weak handle owned by the proxy to cleanup the NativeState on the
+  // C++ heap. cppgc wrappers are owned by the unified heap instead.
+  if (!cppHeap_) {
+    nativeStateProxy->BindFinalizer(v8Object);
+  }
 }
 
 jsi::Value V8Runtime::getProperty(
     const jsi::Object &object,
     const jsi::PropNameID &name) {
+  RNV8_INSTRUMENT_JSI(kGetProperty);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1051,6 +2286,7 @@ jsi::Value V8Runtime::getProperty(
 jsi::Value V8Runtime::getProperty(
     const jsi::Object &object,
     const jsi::String &name) {
+  RNV8_INSTRUMENT_JSI(kGetProperty);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1075,6 +2311,7 @@ jsi::Value V8Runtime::getProperty(
 bool V8Runtime::hasProperty(
     const jsi::Object &object,
     const jsi::PropNameID &name) {
+  RNV8_INSTRUMENT_JSI(kHasProperty);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1100,6 +2337,7 @@ bool V8Runtime::hasProperty(
 bool V8Runtime::hasProperty(
     const jsi::Object &object,
     const jsi::String &name) {
+  RNV8_INSTRUMENT_JSI(kHasProperty);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1130,6 +2368,7 @@ void V8Runtime::setPropertyValue(
 #endif
     const jsi::PropNameID &name,
     const jsi::Value &value) {
+  RNV8_INSTRUMENT_JSI(kSetPropertyValue);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1156,6 +2395,7 @@ void V8Runtime::setPropertyValue(
 #endif
     const jsi::String &name,
     const jsi::Value &value) {
+  RNV8_INSTRUMENT_JSI(kSetPropertyValue);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1306,7 +2546,15 @@ jsi::Array V8Runtime::createArray(size_t length) {
 
 jsi::ArrayBuffer V8Runtime::createArrayBuffer(
     std::shared_ptr<jsi::MutableBuffer> buffer) {
-  throw std::logic_error("Not implemented");
+  v8::Locker locker(isolate_);
+  v8::Isolate::Scope scopedIsolate(isolate_);
+  v8::HandleScope scopedHandle(isolate_);
+  v8::Context::Scope scopedContext(context_.Get(isolate_));
+
+  v8::Local<v8::ArrayBuffer> v8ArrayBuffer =
+      CreateV8ArrayBuffer(std::move(buffer));
+  return make<jsi::Object>(new V8PointerValue(isolate_, v8ArrayBuffer))
+      .getArrayBuffer(*this);
 }
 
 size_t V8Runtime::size(const jsi::Array &array) {
@@ -1319,11 +2567,12 @@ size_t V8Runtime::size(const jsi::Array &array) {
   return v8Array->Length();
 }
 
+// The ArrayBuffer accessors below do not need a context, so they skip the
+// Context::Scope setup for the hot native buffer access path.
 size_t V8Runtime::size(const jsi::ArrayBuffer &arrayBuffer) {
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
-  v8::Context::Scope scopedContext(context_.Get(isolate_));
 
   v8::Local<v8::Object> v8Object =
       JSIV8ValueConverter::ToV8Object(*this, arrayBuffer);
@@ -1336,16 +2585,16 @@ uint8_t *V8Runtime::data(const jsi::ArrayBuffer &arrayBuffer) {
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
-  v8::Context::Scope scopedContext(context_.Get(isolate_));
 
   v8::Local<v8::Object> v8Object =
       JSIV8ValueConverter::ToV8Object(*this, arrayBuffer);
   assert(v8Object->IsArrayBuffer());
   v8::ArrayBuffer *v8ArrayBuffer = v8::ArrayBuffer::Cast(*v8Object);
-  return reinterpret_cast<uint8_t *>(v8ArrayBuffer->GetBackingStore()->Data());
+  return GetArrayBufferDataPointer(v8ArrayBuffer);
 }
 
 jsi::Value V8Runtime::getValueAtIndex(const jsi::Array &array, size_t i) {
+  RNV8_INSTRUMENT_JSI(kGetValueAtIndex);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1368,6 +2617,7 @@ void V8Runtime::setValueAtIndexImpl(
 #endif
     size_t i,
     const jsi::Value &value) {
+  RNV8_INSTRUMENT_JSI(kSetValueAtIndex);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1387,6 +2637,7 @@ jsi::Function V8Runtime::createFunctionFromHostFunction(
     const jsi::PropNameID &name,
     unsigned int paramCount,
     jsi::HostFunctionType func) {
+  RNV8_INSTRUMENT_JSI(kCreateFunctionFromHostFunction);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
@@ -1423,6 +2674,10 @@ jsi::Function V8Runtime::createFunctionFromHostFunction(
 
   v8::Local<v8::String> v8Name = JSIV8ValueConverter::ToV8String(*this, name);
   v8FunctionContainer->SetName(v8Name);
+#if RNV8_ENABLE_INSTRUMENTATION
+  hostFunctionProxy->SetInstrumentationName(
+      "HostFunction:" + JSIV8ValueConverter::ToSTLString(isolate_, v8Name));
+#endif
 
   return make<jsi::Object>(new V8PointerValue(isolate_, v8FunctionContainer))
       .getFunction(*this);
@@ -1433,11 +2688,13 @@ jsi::Value V8Runtime::call(
     const jsi::Value &jsThis,
     const jsi::Value *args,
     size_t count) {
+  RNV8_INSTRUMENT_JSI(kCall);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
   v8::Context::Scope scopedContext(context_.Get(isolate_));
 
+  V8Watchdog::Scope scopedWatchdog(watchdog_.get());
   v8::TryCatch tryCatch(isolate_);
   v8::Local<v8::Function> v8Function =
       JSIV8ValueConverter::ToV8Function(*this, function);
@@ -1477,11 +2734,13 @@ jsi::Value V8Runtime::callAsConstructor(
     const jsi::Function &function,
     const jsi::Value *args,
     size_t count) {
+  RNV8_INSTRUMENT_JSI(kCallAsConstructor);
   v8::Locker locker(isolate_);
   v8::Isolate::Scope scopedIsolate(isolate_);
   v8::HandleScope scopedHandle(isolate_);
   v8::Context::Scope scopedContext(context_.Get(isolate_));
 
+  V8Watchdog::Scope scopedWatchdog(watchdog_.get());
   v8::TryCatch tryCatch(isolate_);
   v8::Local<v8::Function> v8Function =
       JSIV8ValueConverter::ToV8Function(*this, function);
@@ -1499,13 +2758,12 @@ jsi::Value V8Runtime::callAsConstructor(
                static_cast<int>(count),
                argv.data())
            .ToLocal(&v8Object)) {
+    if (tryCatch.HasCaught()) {
+      ReportException(isolate_, &tryCatch);
+    }
     throw jsi::JSError(*this, "CallAsConstructor failed");
   }
 
-  if (tryCatch.HasCaught()) {
-    ReportException(isolate_, &tryCatch);
-  }
-
   return JSIV8ValueConverter::ToJSIValue(isolate_, v8Object);
 }
 
@@ -1609,6 +2867,23 @@ void V8Runtime::setExternalMemoryPressure(
 // JS function/object handler callbacks
 //
 
+// static
+size_t V8Runtime::NearHeapLimitCallback(
+    void *data,
+    size_t currentHeapLimit,
+    size_t initialHeapLimit) {
+  auto *runtime = static_cast<V8Runtime *>(data);
+  if (runtime->nearHeapLimitSnapshotWritten_) {
+    return currentHeapLimit;
+  }
+  runtime->nearHeapLimitSnapshotWritten_ = true;
+  LOG(WARNING) << "[rnv8] Heap is close to its limit, writing a heap snapshot "
+               << "to " << runtime->config_->nearHeapLimitSnapshotPath;
+  runtime->WriteHeapSnapshot(runtime->config_->nearHeapLimitSnapshotPath);
+  // Taking the snapshot allocates, leave room to finish the current task
+  return currentHeapLimit + initialHeapLimit / 2;
+}
+
 // static
 void V8Runtime::GetRuntimeInfo(
     const v8::FunctionCallbackInfo<v8::Value> &args) {
@@ -1617,46 +2892,52 @@ void V8Runtime::GetRuntimeInfo(
   v8::Local<v8::Object> runtimeInfo = v8::Object::New(isolate);
   v8::Local<v8::Context> context(isolate->GetCurrentContext());
 
-  v8::Local<v8::String> versionKey =
-      v8::String::NewFromUtf8(isolate, "version", v8::NewStringType::kNormal)
-          .ToLocalChecked();
-  v8::Local<v8::String> versionValue =
-      v8::String::NewFromUtf8(
-          args.GetIsolate(), v8::V8::GetVersion(), v8::NewStringType::kNormal)
-          .ToLocalChecked();
-  runtimeInfo->Set(context, versionKey, versionValue).Check();
-
-  v8::Local<v8::String> memoryKey =
-      v8::String::NewFromUtf8(isolate, "memory", v8::NewStringType::kNormal)
-          .ToLocalChecked();
-  v8::Local<v8::Object> memoryInfo = v8::Object::New(isolate);
-  v8::HeapStatistics heapStats;
-  isolate->GetHeapStatistics(&heapStats);
-  memoryInfo
-      ->Set(
-          context,
-          v8::String::NewFromUtf8(
-              isolate, "jsHeapSizeLimit", v8::NewStringType::kNormal)
-              .ToLocalChecked(),
-          v8::Number::New(isolate, heapStats.heap_size_limit()))
-      .Check();
-  memoryInfo
-      ->Set(
-          context,
-          v8::String::NewFromUtf8(
-              isolate, "totalJSHeapSize", v8::NewStringType::kNormal)
-              .ToLocalChecked(),
-          v8::Number::New(isolate, heapStats.total_heap_size()))
-      .Check();
-  memoryInfo
-      ->Set(
-          context,
-          v8::String::NewFromUtf8(
-              isolate, "usedJSHeapSize", v8::NewStringType::kNormal)
-              .ToLocalChecked(),
-          v8::Number::New(isolate, heapStats.used_heap_size()))
-      .Check();
-  runtimeInfo->Set(context, memoryKey, memoryInfo).Check();
+  auto *runtime =
+      static_cast<V8Runtime *>(args.Data().As<v8::External>()->Value());
+  if (!runtime->runtimeInfoKeys_) {
+    runtime->runtimeInfoKeys_ = std::make_unique<RuntimeInfoKeys>(isolate);
+  }
+  RuntimeInfoKeys &keys = *runtime->runtimeInfoKeys_;
+
+  SetValue(
+      context, keys, runtimeInfo, "version", keys.Get(v8::V8::GetVersion()));
+  // `_v8runtime({ codeStatistics: true })` adds `memory.code`
+  bool includeCodeStatistics = false;
+  if (args.Length() > 0 && args[0]->IsObject()) {
+    v8::Local<v8::Value> value;
+    includeCodeStatistics =
+        args[0]
+            .As<v8::Object>()
+            ->Get(context, keys.Get("codeStatistics"))
+            .ToLocal(&value) &&
+        value->BooleanValue(isolate);
+  }
+  SetValue(
+      context,
+      keys,
+      runtimeInfo,
+      "memory",
+      CreateMemoryInfo(
+          context, keys, runtime->GetHeapInfo(includeCodeStatistics)));
+  SetValue(
+      context,
+      keys,
+      runtimeInfo,
+      "codeCache",
+      CreateCodeCacheInfo(context, keys, runtime->codeCacheStats_));
+  v8::Local<v8::Object> startupMarkers = v8::Object::New(isolate);
+  for (const auto &[name, timeMs] : runtime->startupMarkers_) {
+    SetNumber(context, keys, startupMarkers, name, timeMs);
+  }
+  SetValue(context, keys, runtimeInfo, "startupMarkers", startupMarkers);
+  if (runtime->gcTelemetry_) {
+    SetValue(
+        context,
+        keys,
+        runtimeInfo,
+        "gc",
+        CreateGCInfo(context, keys, runtime->gcTelemetry_->GetStats()));
+  }
 
   args.GetReturnValue().Set(runtimeInfo);
 }
@@ -8,9 +8,22 @@
 #pragma once
 
 #include <cxxreact/MessageQueueThread.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "V8CodeCacheStats.h"
+#include "V8GCTelemetry.h"
+#include "V8HeapInfo.h"
 #include "V8RuntimeConfig.h"
 #include "jsi/jsi.h"
 #include "libplatform/libplatform.h"
+#include "v8-cppgc.h"
+#include "v8-profiler.h"
 #include "v8.h"
 
 namespace rnv8 {
@@ -18,21 +31,136 @@ namespace rnv8 {
 class V8Runtime;
 class V8PointerValue;
 class InspectorClient;
+class DeferredFinalizer;
+class V8PromiseResolver;
+class V8Timers;
+class V8Platform;
+class V8Watchdog;
+class RuntimeInfoKeys;
+
+// Optional interface for HostObject/NativeState implementations when
+// `enableCppgc` is on. Implementations holding JS values as
+// v8::TracedReference can trace them here, so cycles between JS objects and
+// the C++ payload are collected by the unified heap. `Trace` may be called
+// from concurrent marking threads.
+class CppgcTraceable {
+ public:
+  virtual ~CppgcTraceable() = default;
+  virtual void Trace(cppgc::Visitor *visitor) const = 0;
+};
 
 class V8Runtime : public facebook::jsi::Runtime {
  public:
   V8Runtime(
       std::unique_ptr<V8RuntimeConfig> config,
       std::shared_ptr<facebook::react::MessageQueueThread> jsQueue);
+  // With `enableSharedIsolate`, the runtime is a new context in the isolate
+  // of `v8Runtime`. Both runtimes then share the JS queue and serialize
+  // through the isolate's v8::Locker, and the shared runtime must be destroyed
+  // before `v8Runtime`. Objects created by one runtime must not be kept alive
+  // by the other after it is destroyed.
   V8Runtime(
       const V8Runtime *v8Runtime,
       std::unique_ptr<V8RuntimeConfig> config);
   ~V8Runtime();
 
+  // For runtimes created without a JS queue (prewarming), attaches the queue
+  // for platform tasks and connects the inspector if enabled.
+  void AttachJSQueue(
+      std::shared_ptr<facebook::react::MessageQueueThread> jsQueue);
+
+  // Returns the config the runtime was created with
+  const V8RuntimeConfig &GetConfig() const {
+    return *config_;
+  }
+
   // Calling this function when the platform main runloop is idle
   void OnMainLoopIdle();
 
+  // Returns the data pointer and byte length of an ArrayBuffer,
+  // SharedArrayBuffer or ArrayBufferView (TypedArray/DataView) in one call.
+  // For views, the pointer is already adjusted by the view's byte offset.
+  std::pair<uint8_t *, size_t> GetArrayBufferData(
+      const facebook::jsi::Object &object);
+
+  enum struct TypedArrayType : uint8_t {
+    kUint8 = 0,
+    kInt32,
+    kFloat32,
+    kFloat64,
+  };
+
+  // Creates a TypedArray over the whole MutableBuffer without copying.
+  // The buffer is kept alive until V8 releases the underlying ArrayBuffer.
+  facebook::jsi::Object CreateTypedArray(
+      TypedArrayType type,
+      std::shared_ptr<facebook::jsi::MutableBuffer> buffer);
+
+  // Returns the number of HostObject/HostFunction/NativeState payloads
+  // waiting for destruction when `enableDeferredFinalization` is on.
+  size_t GetPendingFinalizationCount() const;
+
+  // Creates a TypedArray view over an existing ArrayBuffer without copying.
+  // `length` is the number of elements rather than bytes.
+  facebook::jsi::Object CreateTypedArray(
+      TypedArrayType type,
+      const facebook::jsi::ArrayBuffer &arrayBuffer,
+      size_t byteOffset,
+      size_t length);
+
+  // Creates a pending promise and the resolver to settle it, e.g. from the
+  // completion of an async host function on another thread. Needs a JS queue.
+  std::pair<facebook::jsi::Value, std::shared_ptr<V8PromiseResolver>>
+  CreatePromise();
+
+  // Starts the sampling CPU profiler on the JS thread. `samplingIntervalUs`
+  // of 0 keeps V8's default interval of 1000us.
+  void StartCpuProfiler(int samplingIntervalUs = 0);
+
+  // Stops the sampling CPU profiler and writes a .cpuprofile to `filename`.
+  // Returns false if the profiler is not running or the file cannot be
+  // written.
+  bool StopCpuProfiler(const std::string &filename);
+
+  // Starts the sampling heap profiler, which records the allocation sites of
+  // about one allocation per `samplingIntervalBytes`. 0 keeps V8's default
+  // of 512KB.
+  void StartHeapSamplingProfiler(uint64_t samplingIntervalBytes = 0);
+
+  // Stops the sampling heap profiler and writes the allocations still alive
+  // as a .heapprofile to `filename`. Returns false if the profiler is not
+  // running or the file cannot be written.
+  bool StopHeapSamplingProfiler(const std::string &filename);
+
+  // Takes a heap snapshot and streams it as a .heapsnapshot to `filename`.
+  // Safe to call when the heap is close to its limit. Returns false if the
+  // file cannot be written.
+  bool WriteHeapSnapshot(const std::string &filename);
+
+  // Returns the GC pauses recorded so far, or nothing without
+  // `enableGCTelemetry`.
+  std::optional<V8GCStats> GetGCStats() const;
+
+  // Startup milestones in ms since the runtime was created, e.g.
+  // "isolateCreated" or "scriptRun", in the order they happened. Also
+  // emitted as systrace markers and available as
+  // `global._v8runtime().startupMarkers`. JS thread only.
+  const std::vector<std::pair<const char *, double>> &GetStartupMarkers()
+      const;
+
+  // Code cache outcome and timings of the evaluated scripts, also available
+  // as `global._v8runtime().codeCache`. JS thread only.
+  const V8CodeCacheStats &GetCodeCacheStats() const;
+
+  // Heap, engine and jsi object counts, also available as
+  // `global._v8runtime().memory`. Cheap enough for periodic sampling, unless
+  // `includeCodeStatistics` is set, which walks the whole heap.
+  V8HeapInfo GetHeapInfo(bool includeCodeStatistics = false);
+
  private:
+  void InitializeWithSharedIsolate(const V8Runtime *parentRuntime);
+  void CreateWatchdogIfNeeded();
+  void LogStartupMarker(const char *name);
   v8::Local<v8::Context> CreateGlobalContext(v8::Isolate *isolate);
   facebook::jsi::Value ExecuteScript(
       v8::Isolate *isolate,
@@ -40,16 +168,55 @@ class V8Runtime : public facebook::jsi::Runtime {
       const std::string &sourceURL);
   void ReportException(v8::Isolate *isolate, v8::TryCatch *tryCatch) const;
 
+  v8::Local<v8::ArrayBuffer> CreateV8ArrayBuffer(
+      std::shared_ptr<facebook::jsi::MutableBuffer> buffer);
+  v8::Local<v8::TypedArray> CreateV8TypedArray(
+      TypedArrayType type,
+      v8::Local<v8::ArrayBuffer> arrayBuffer,
+      size_t byteOffset,
+      size_t length);
+
   std::unique_ptr<v8::ScriptCompiler::CachedData> LoadCodeCacheIfNeeded(
-      const std::string &sourceURL);
+      const std::string &sourceURL,
+      V8CodeCacheRecord &record);
   bool SaveCodeCacheIfNeeded(
       const v8::Local<v8::Script> &script,
       const std::string &sourceURL,
-      v8::ScriptCompiler::CachedData *cachedData);
+      v8::ScriptCompiler::CachedData *cachedData,
+      V8CodeCacheRecord &record);
+  void AddCodeCacheRecord(V8CodeCacheRecord &&record);
   std::unique_ptr<v8::ScriptCompiler::Source> UseFakeSourceIfNeeded(
       const v8::ScriptOrigin &origin,
       v8::ScriptCompiler::CachedData *cachedData);
 
+  // For isolate recycling, compiled scripts are kept across runtimes and
+  // bound to the new context when the same source is evaluated again.
+  struct RecycledScript {
+    v8::Global<v8::String> source;
+    v8::Global<v8::UnboundScript> script;
+  };
+  v8::Local<v8::Script> BindRecycledScript(
+      v8::Isolate *isolate,
+      const v8::Local<v8::String> &source,
+      const std::string &sourceURL);
+  void RetainScriptIfNeeded(
+      v8::Isolate *isolate,
+      const v8::Local<v8::Script> &script,
+      const v8::Local<v8::String> &source,
+      const std::string &sourceURL);
+
+  // An isolate parked by a destroyed runtime for the next one to adopt
+  struct RecycledIsolate {
+    ~RecycledIsolate();
+
+    v8::Isolate *isolate = nullptr;
+    std::shared_ptr<v8::ArrayBuffer::Allocator> arrayBufferAllocator;
+    std::unique_ptr<v8::StartupData> snapshotBlob;
+    std::unique_ptr<const facebook::react::JSBigString> snapshotBlobData;
+    std::unordered_map<std::string, RecycledScript> scripts;
+  };
+  void RecycleIsolate();
+
   enum InternalFieldType {
     kInvalid = 0,
     kHostObject = 1,
@@ -58,7 +225,25 @@ class V8Runtime : public facebook::jsi::Runtime {
   };
   InternalFieldType GetInternalFieldType(v8::Local<v8::Object> object) const;
 
+  // For cppgc wrappers, the internal fields follow the v8::WrapperDescriptor
+  // layout: field 0 is the type info and field 1 is the GarbageCollected
+  // instance.
+  void AttachCppHeap();
+  void SetWrapperInternalFields(
+      v8::Local<v8::Object> object,
+      InternalFieldType type,
+      void *wrappable);
+  void ReleaseSweptPayload(std::shared_ptr<void> payload);
+  void ReleaseSweptPayloads();
+
   static v8::Platform *GetPlatform();
+  // The platform to pass to `v8::platform::PumpMessageLoop()`
+  static v8::Platform *GetMessageLoopPlatform();
+  // Creates the isolate and routes its foreground tasks to `jsQueue` when the
+  // custom V8Platform is in use
+  static v8::Isolate *NewIsolate(
+      const v8::Isolate::CreateParams &createParams,
+      const std::shared_ptr<facebook::react::MessageQueueThread> &jsQueue);
 
   //
   // facebook::jsi::Runtime implementations
@@ -80,6 +265,9 @@ class V8Runtime : public facebook::jsi::Runtime {
   void queueMicrotask(const facebook::jsi::Function &callback) override;
 #endif // REACT_NATIVE_MINOR_VERSION >= 75 || (REACT_NATIVE_MINOR_VERSION >= 74
        // && REACT_NATIVE_PATCH_VERSION >= 3
+  // V8 cannot stop a microtask checkpoint halfway, so `maxMicrotasksHint`
+  // cannot bound the microtasks run. The queue is always drained, a hint of 0
+  // only skips pumping the pending platform tasks first.
   bool drainMicrotasks(int maxMicrotasksHint = -1) override;
 
   facebook::jsi::Object global() override;
@@ -253,6 +441,12 @@ class V8Runtime : public facebook::jsi::Runtime {
  private:
   friend class V8PointerValue;
   friend class JSIV8ValueConverter;
+  friend class HostObjectProxy;
+  friend class HostFunctionProxy;
+  friend class NativeStateProxy;
+  friend class V8MessageChannel;
+  friend class V8PromiseResolver;
+  friend class V8Timers;
 
   //
   // JS function/object handler callbacks
@@ -261,22 +455,56 @@ class V8Runtime : public facebook::jsi::Runtime {
   // For `global._v8runtime()`
   static void GetRuntimeInfo(const v8::FunctionCallbackInfo<v8::Value> &args);
 
+  // For `nearHeapLimitSnapshotPath`
+  static size_t NearHeapLimitCallback(
+      void *data,
+      size_t currentHeapLimit,
+      size_t initialHeapLimit);
+
   // For `HostFunctionContainer()`, will call underlying HostFunction
   static void OnHostFuncionContainerCallback(
       const v8::FunctionCallbackInfo<v8::Value> &args);
 
  private:
   static std::unique_ptr<v8::Platform> s_platform;
+  // `s_platform` when `enableCustomPlatform` is on. libplatform is built
+  // without RTTI, so the platform cannot be told apart with dynamic_cast.
+  static V8Platform *s_customPlatform;
+  static std::unique_ptr<RecycledIsolate> s_recycledIsolate;
 
  private:
   std::unique_ptr<V8RuntimeConfig> config_;
-  std::unique_ptr<v8::ArrayBuffer::Allocator> arrayBufferAllocator_;
+  // Shared with the backing stores transferred to other runtimes
+  std::shared_ptr<v8::ArrayBuffer::Allocator> arrayBufferAllocator_;
   std::unique_ptr<v8::StartupData> snapshotBlob_;
   v8::Isolate *isolate_;
   v8::Global<v8::Context> context_;
   std::shared_ptr<InspectorClient> inspectorClient_;
   bool isSharedRuntime_ = false;
+  const V8Runtime *parentRuntime_ = nullptr;
+  mutable std::atomic<int> sharedRuntimeCount_{0};
   std::shared_ptr<facebook::react::MessageQueueThread> jsQueue_;
+  std::unique_ptr<DeferredFinalizer> deferredFinalizer_;
+  std::shared_ptr<V8Watchdog> watchdog_;
+  std::shared_ptr<V8Timers> timers_;
+  std::unique_ptr<V8GCTelemetry> gcTelemetry_;
+  std::chrono::steady_clock::time_point createdTime_ =
+      std::chrono::steady_clock::now();
+  std::vector<std::pair<const char *, double>> startupMarkers_;
+  V8CodeCacheStats codeCacheStats_;
+  std::unique_ptr<RuntimeInfoKeys> runtimeInfoKeys_;
+  v8::CpuProfiler *cpuProfiler_ = nullptr;
+  bool nearHeapLimitSnapshotWritten_ = false;
+  std::unique_ptr<v8::CppHeap> cppHeap_;
+  std::mutex sweptPayloadsMutex_;
+  std::vector<std::shared_ptr<void>> sweptPayloads_;
+  std::unordered_map<std::string, RecycledScript> recycledScripts_;
+  // Handles of the promise resolvers, released with the context since the
+  // isolate may outlive the runtime. Only accessed under the isolate lock.
+  std::vector<std::weak_ptr<v8::Global<v8::Promise::Resolver>>>
+      promiseResolvers_;
+  // Lets work posted to the JS queue find out whether the runtime is gone
+  std::shared_ptr<V8Runtime *> selfRef_ = std::make_shared<V8Runtime *>(this);
 };
 
 } // namespace rnv8
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cxxreact/JSBigString.h>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,97 @@ struct V8RuntimeConfig {
 
   // The directory to store codecache files
   std::string codecacheDir;
+
+  // true to destroy HostObject/HostFunction/NativeState payloads on the JS
+  // thread in the next idle slot, i.e. `OnMainLoopIdle()` or
+  // `drainMicrotasks()`, instead of inside GC weak callbacks
+  bool enableDeferredFinalization = false;
+
+  // true to keep HostObject/NativeState wrappers on the V8 unified heap
+  // (cppgc) instead of weak global handles
+  bool enableCppgc = false;
+
+  // true to run V8 foreground tasks (GC, compilation finalization) directly on
+  // the JS queue and background tasks on a priority aware worker pool instead
+  // of the default platform. Only the first runtime initializes the platform.
+  bool enableCustomPlatform = false;
+
+  // Number of platform worker threads, 0 to use the number of cores - 1
+  int platformWorkerThreadCount = 0;
+
+  // Nice value of platform worker threads. On iOS, a positive value lowers
+  // the QoS class to utility.
+  int platformWorkerThreadPriority = 0;
+
+  // Comma separated V8 trace categories, e.g. "v8,v8.compile", whose events
+  // are emitted as systrace sections. "*" for all the categories enabled by
+  // default. Empty to disable. Like the platform options, only the first
+  // runtime applies it.
+  std::string v8TraceCategories;
+
+  // true to dispose the isolate on a background thread when the runtime is
+  // destroyed, so reloads don't block while the heap is freed. Keep it false
+  // where synchronous teardown is expected, e.g. tests.
+  bool enableAsyncTeardown = false;
+
+  // true to keep the isolate when the runtime is destroyed and reuse it with
+  // a fresh context in the next runtime, e.g. across React instance reloads.
+  // Compiled bundles are kept as well and run without recompiling when the
+  // source is unchanged.
+  bool enableIsolateRecycling = false;
+
+  // true to run microtasks only from `drainMicrotasks()` instead of whenever
+  // the JS call depth drops to zero. The host has to drain them, e.g. the
+  // RuntimeScheduler of the new architecture. Runtimes sharing an isolate
+  // follow the policy of the parent runtime.
+  bool enableExplicitMicrotasks = false;
+
+  // Milliseconds a JSI call into JS, e.g. `evaluateJavaScript()` or `call()`,
+  // may run before the watchdog logs a long task report with the current JS
+  // stack. 0 to disable the watchdog.
+  uint32_t watchdogTimeoutMs = 0;
+
+  // true to also terminate the JS execution when the watchdog fires. The
+  // outermost JSI call then throws a jsi::JSError and the runtime stays
+  // usable.
+  bool watchdogTerminateExecution = false;
+
+  // true to install native setTimeout/setInterval/requestIdleCallback on the
+  // global object, scheduled straight on the JS queue instead of going
+  // through the Timing native module. React Native's `setUpTimers` polyfill
+  // replaces these globals with its JS timers when `InitializeCore` runs, so
+  // they only serve code evaluated before it, e.g. bundle prelude scripts,
+  // unless the app leaves out the timer polyfill.
+  bool enableNativeTimers = false;
+
+  // When not empty, a heap snapshot is written to this path the first time
+  // the heap gets close to its limit, before V8 fails with out of memory.
+  // Ignored by runtimes sharing an isolate, which follow the parent runtime.
+  std::string nearHeapLimitSnapshotPath;
+
+  // true to record the pauses of the GCs, available from
+  // `V8Runtime::GetGCStats()` and as `global._v8runtime().gc`
+  bool enableGCTelemetry = false;
+
+  // true to also emit a systrace section for every GC, requires
+  // `enableGCTelemetry`
+  bool enableGCSystrace = false;
+
+  // For runtimes created by `createSharedV8Runtime()`, true to create a new
+  // context in the parent runtime's isolate instead of a new isolate.
+  // Not supported when the parent runtime uses `enableCppgc`.
+  bool enableSharedIsolate = false;
 };
 
+// Returns true if both snapshot blobs are absent or have the same content
+inline bool IsSameSnapshotBlob(
+    const facebook::react::JSBigString *lhs,
+    const facebook::react::JSBigString *rhs) {
+  if (!lhs || !rhs) {
+    return lhs == rhs;
+  }
+  return lhs->size() == rhs->size() &&
+      std::memcmp(lhs->c_str(), rhs->c_str(), lhs->size()) == 0;
+}
+
 } // namespace rnv8
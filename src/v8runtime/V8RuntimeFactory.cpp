@@ -7,16 +7,88 @@
 
 #include "V8RuntimeFactory.h"
 
+#include <glog/logging.h>
+#include <future>
+#include <mutex>
 #include "V8Runtime.h"
 
 namespace rnv8 {
 
+namespace {
+
+std::mutex s_prewarmMutex; // protects s_prewarmedRuntime
+std::future<std::unique_ptr<V8Runtime>> s_prewarmedRuntime;
+
+bool IsSameConfig(const V8RuntimeConfig &lhs, const V8RuntimeConfig &rhs) {
+  return lhs.timezoneId == rhs.timezoneId &&
+      lhs.enableInspector == rhs.enableInspector &&
+      lhs.appName == rhs.appName && lhs.deviceName == rhs.deviceName &&
+      IsSameSnapshotBlob(lhs.snapshotBlob.get(), rhs.snapshotBlob.get()) &&
+      lhs.codecacheMode == rhs.codecacheMode &&
+      lhs.codecacheDir == rhs.codecacheDir &&
+      lhs.enableDeferredFinalization == rhs.enableDeferredFinalization &&
+      lhs.enableCppgc == rhs.enableCppgc &&
+      lhs.enableCustomPlatform == rhs.enableCustomPlatform &&
+      lhs.platformWorkerThreadCount == rhs.platformWorkerThreadCount &&
+      lhs.platformWorkerThreadPriority == rhs.platformWorkerThreadPriority &&
+      lhs.v8TraceCategories == rhs.v8TraceCategories &&
+      lhs.enableAsyncTeardown == rhs.enableAsyncTeardown &&
+      lhs.enableIsolateRecycling == rhs.enableIsolateRecycling &&
+      lhs.enableExplicitMicrotasks == rhs.enableExplicitMicrotasks &&
+      lhs.watchdogTimeoutMs == rhs.watchdogTimeoutMs &&
+      lhs.watchdogTerminateExecution == rhs.watchdogTerminateExecution &&
+      lhs.enableNativeTimers == rhs.enableNativeTimers &&
+      lhs.nearHeapLimitSnapshotPath == rhs.nearHeapLimitSnapshotPath &&
+      lhs.enableGCTelemetry == rhs.enableGCTelemetry &&
+      lhs.enableGCSystrace == rhs.enableGCSystrace &&
+      lhs.enableSharedIsolate == rhs.enableSharedIsolate;
+}
+
+} // namespace
+
 std::unique_ptr<facebook::jsi::Runtime> createV8Runtime(
     std::unique_ptr<V8RuntimeConfig> config,
     std::shared_ptr<facebook::react::MessageQueueThread> jsQueue) {
   return std::make_unique<V8Runtime>(std::move(config), jsQueue);
 }
 
+void prewarmV8Runtime(std::unique_ptr<V8RuntimeConfig> config) {
+  const std::lock_guard<std::mutex> lock(s_prewarmMutex);
+  if (s_prewarmedRuntime.valid()) {
+    return;
+  }
+  s_prewarmedRuntime = std::async(
+      std::launch::async, [config = std::move(config)]() mutable {
+        return std::make_unique<V8Runtime>(std::move(config), nullptr);
+      });
+}
+
+std::unique_ptr<facebook::jsi::Runtime> takePrewarmedV8Runtime(
+    const V8RuntimeConfig &config,
+    std::shared_ptr<facebook::react::MessageQueueThread> jsQueue) {
+  std::future<std::unique_ptr<V8Runtime>> prewarmedRuntime;
+  {
+    const std::lock_guard<std::mutex> lock(s_prewarmMutex);
+    if (!s_prewarmedRuntime.valid()) {
+      return nullptr;
+    }
+    prewarmedRuntime = std::move(s_prewarmedRuntime);
+  }
+  std::unique_ptr<V8Runtime> runtime;
+  try {
+    runtime = prewarmedRuntime.get();
+  } catch (const std::exception &ex) {
+    LOG(ERROR) << "[rnv8] Unable to prewarm the runtime: " << ex.what();
+    return nullptr;
+  }
+  if (!IsSameConfig(runtime->GetConfig(), config)) {
+    LOG(WARNING) << "[rnv8] Prewarmed runtime config mismatched, discarded";
+    return nullptr;
+  }
+  runtime->AttachJSQueue(std::move(jsQueue));
+  return runtime;
+}
+
 std::unique_ptr<facebook::jsi::Runtime> createSharedV8Runtime(
     const facebook::jsi::Runtime *sharedRuntime,
     std::unique_ptr<V8RuntimeConfig> config) {
@@ -18,6 +18,19 @@ std::unique_ptr<facebook::jsi::Runtime> createV8Runtime(
     std::unique_ptr<V8RuntimeConfig> config,
     std::shared_ptr<facebook::react::MessageQueueThread> jsQueue);
 
+// Creates a runtime with `config` on a background thread, so that the V8
+// initialization, snapshot deserialization and global context setup are off
+// the startup critical path. Only one runtime is prewarmed at a time.
+void prewarmV8Runtime(std::unique_ptr<V8RuntimeConfig> config);
+
+// Returns the prewarmed runtime bound to `jsQueue`, waiting for it if it is
+// still being created. Returns nullptr if there is none, its creation failed
+// or it was prewarmed with a config different from `config`, in which case
+// the caller should create the runtime as usual.
+std::unique_ptr<facebook::jsi::Runtime> takePrewarmedV8Runtime(
+    const V8RuntimeConfig &config,
+    std::shared_ptr<facebook::react::MessageQueueThread> jsQueue);
+
 std::unique_ptr<facebook::jsi::Runtime> createSharedV8Runtime(
     const facebook::jsi::Runtime *sharedRuntime,
     std::unique_ptr<V8RuntimeConfig> config);
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8Timers.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "JSIV8ValueConverter.h"
+#include "V8Runtime.h"
+
+namespace rnv8 {
+
+namespace {
+
+void SetFunction(
+    v8::Isolate *isolate,
+    v8::Local<v8::ObjectTemplate> global,
+    const char *name,
+    v8::FunctionCallback callback,
+    v8::Local<v8::External> data) {
+  global->Set(
+      v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kNormal)
+          .ToLocalChecked(),
+      v8::FunctionTemplate::New(isolate, callback, data));
+}
+
+V8Timers *GetTimers(const v8::FunctionCallbackInfo<v8::Value> &args) {
+  return static_cast<V8Timers *>(args.Data().As<v8::External>()->Value());
+}
+
+uint32_t GetId(const v8::FunctionCallbackInfo<v8::Value> &args) {
+  if (args.Length() < 1 || !args[0]->IsNumber()) {
+    return 0;
+  }
+  return args[0]
+      ->Uint32Value(args.GetIsolate()->GetCurrentContext())
+      .FromMaybe(0);
+}
+
+void IdleDeadlineTimeRemaining(
+    const v8::FunctionCallbackInfo<v8::Value> &args) {
+  double deadline = args.Data().As<v8::Number>()->Value();
+  double now = std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count();
+  args.GetReturnValue().Set(std::max(0.0, deadline - now));
+}
+
+// Runs on a platform worker thread when the earliest timer is due
+class WakeUpTask final : public v8::Task {
+ public:
+  explicit WakeUpTask(std::function<void()> callback)
+      : callback_(std::move(callback)) {}
+
+  void Run() override {
+    callback_();
+  }
+
+ private:
+  std::function<void()> callback_;
+};
+
+} // namespace
+
+V8Timers::V8Timers(V8Runtime &runtime) : runtime_(runtime) {}
+
+V8Timers::~V8Timers() = default;
+
+void V8Timers::InstallGlobals(
+    v8::Isolate *isolate,
+    v8::Local<v8::ObjectTemplate> global) {
+  v8::Local<v8::External> data = v8::External::New(isolate, this);
+  SetFunction(isolate, global, "setTimeout", SetTimeout, data);
+  SetFunction(isolate, global, "setInterval", SetInterval, data);
+  SetFunction(isolate, global, "clearTimeout", ClearTimer, data);
+  SetFunction(isolate, global, "clearInterval", ClearTimer, data);
+  SetFunction(
+      isolate, global, "requestIdleCallback", RequestIdleCallback, data);
+  SetFunction(
+      isolate, global, "cancelIdleCallback", CancelIdleCallback, data);
+}
+
+// static
+void V8Timers::SetTimeout(const v8::FunctionCallbackInfo<v8::Value> &args) {
+  GetTimers(args)->AddTimer(args, false);
+}
+
+// static
+void V8Timers::SetInterval(const v8::FunctionCallbackInfo<v8::Value> &args) {
+  GetTimers(args)->AddTimer(args, true);
+}
+
+// static
+void V8Timers::ClearTimer(const v8::FunctionCallbackInfo<v8::Value> &args) {
+  V8Timers *self = GetTimers(args);
+  auto it = self->timers_.find(GetId(args));
+  if (it == self->timers_.end()) {
+    return;
+  }
+  self->Unschedule(it->first, it->second.deadline);
+  self->timers_.erase(it);
+}
+
+// static
+void V8Timers::RequestIdleCallback(
+    const v8::FunctionCallbackInfo<v8::Value> &args) {
+  v8::Isolate *isolate = args.GetIsolate();
+  if (args.Length() < 1 || !args[0]->IsFunction()) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8Literal(
+            isolate, "requestIdleCallback requires a function")));
+    return;
+  }
+  V8Timers *self = GetTimers(args);
+  uint32_t id = self->nextId_++;
+  self->idleCallbacks_.emplace(
+      id, v8::Global<v8::Function>(isolate, args[0].As<v8::Function>()));
+  self->PostIdleTick();
+  args.GetReturnValue().Set(id);
+}
+
+// static
+void V8Timers::CancelIdleCallback(
+    const v8::FunctionCallbackInfo<v8::Value> &args) {
+  GetTimers(args)->idleCallbacks_.erase(GetId(args));
+}
+
+void V8Timers::AddTimer(
+    const v8::FunctionCallbackInfo<v8::Value> &args,
+    bool repeat) {
+  v8::Isolate *isolate = args.GetIsolate();
+  if (args.Length() < 1 || !args[0]->IsFunction()) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8Literal(
+            isolate, "The timer callback must be a function")));
+    return;
+  }
+
+  double delay = 0;
+  if (args.Length() > 1 && args[1]->IsNumber()) {
+    delay = args[1].As<v8::Number>()->Value();
+  }
+  // NaN and infinite delays run immediately, as in browsers
+  if (!std::isfinite(delay)) {
+    delay = 0;
+  }
+  // Intervals of 0 would keep the JS queue busy
+  delay = std::clamp(delay, repeat ? 1.0 : 0.0, kMaxDelayMs);
+
+  uint32_t id = nextId_++;
+  Timer &timer = timers_[id];
+  timer.callback.Reset(isolate, args[0].As<v8::Function>());
+  for (int i = 2; i < args.Length(); ++i) {
+    timer.args.emplace_back(isolate, args[i]);
+  }
+  timer.interval = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double, std::milli>(delay));
+  timer.repeat = repeat;
+  timer.deadline = Clock::now() + timer.interval;
+  Schedule(id, timer.deadline);
+  args.GetReturnValue().Set(id);
+}
+
+void V8Timers::Schedule(uint32_t id, Clock::time_point deadline) {
+  schedule_.emplace(deadline, id);
+  ScheduleWakeUp();
+}
+
+void V8Timers::Unschedule(uint32_t id, Clock::time_point deadline) {
+  auto range = schedule_.equal_range(deadline);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == id) {
+      schedule_.erase(it);
+      return;
+    }
+  }
+}
+
+void V8Timers::ScheduleWakeUp() {
+  if (schedule_.empty()) {
+    return;
+  }
+  Clock::time_point deadline = schedule_.begin()->first;
+  Clock::time_point now = Clock::now();
+  // A wake up that is still ahead and not later than the earliest timer
+  // covers it. Stale wake ups only cost an empty tick.
+  if (wakeUpTime_ > now && wakeUpTime_ <= deadline) {
+    return;
+  }
+  std::shared_ptr<facebook::react::MessageQueueThread> jsQueue =
+      runtime_.jsQueue_;
+  if (!jsQueue) {
+    return;
+  }
+  wakeUpTime_ = deadline;
+  auto tick = [weakThis = weak_from_this()]() {
+    if (auto self = weakThis.lock()) {
+      self->RunTimers();
+    }
+  };
+  if (deadline <= now) {
+    jsQueue->runOnQueue(std::move(tick));
+    return;
+  }
+  // The worker only hops to the JS queue, the timers run there
+  auto wakeUp = [weakJSQueue = std::weak_ptr(jsQueue), tick]() {
+    if (auto jsQueue = weakJSQueue.lock()) {
+      jsQueue->runOnQueue(tick);
+    }
+  };
+  V8Runtime::GetPlatform()->CallDelayedOnWorkerThread(
+      std::make_unique<WakeUpTask>(std::move(wakeUp)),
+      std::chrono::duration<double>(deadline - now).count());
+}
+
+void V8Timers::PostIdleTick() {
+  if (idleTickPending_ || !runtime_.jsQueue_) {
+    return;
+  }
+  idleTickPending_ = true;
+  runtime_.jsQueue_->runOnQueue([weakThis = weak_from_this()]() {
+    if (auto self = weakThis.lock()) {
+      self->RunIdleCallbacks();
+    }
+  });
+}
+
+void V8Timers::RunTimers() {
+  // Everything due by now runs in this tick
+  std::vector<uint32_t> dueIds;
+  auto end = schedule_.upper_bound(Clock::now());
+  for (auto it = schedule_.begin(); it != end; ++it) {
+    dueIds.push_back(it->second);
+  }
+  schedule_.erase(schedule_.begin(), end);
+
+  v8::Isolate *isolate = runtime_.isolate_;
+  v8::Locker locker(isolate);
+  v8::Isolate::Scope scopedIsolate(isolate);
+  v8::HandleScope scopedHandle(isolate);
+  v8::Local<v8::Context> context = runtime_.context_.Get(isolate);
+  v8::Context::Scope scopedContext(context);
+
+  for (uint32_t id : dueIds) {
+    // Earlier callbacks may have cleared the timer
+    auto it = timers_.find(id);
+    if (it == timers_.end()) {
+      continue;
+    }
+    Timer &timer = it->second;
+    v8::Local<v8::Function> callback = timer.callback.Get(isolate);
+    std::vector<v8::Local<v8::Value>> argv;
+    argv.reserve(timer.args.size());
+    for (auto &arg : timer.args) {
+      argv.push_back(arg.Get(isolate));
+    }
+    if (timer.repeat) {
+      timer.deadline = Clock::now() + timer.interval;
+      Schedule(id, timer.deadline);
+    } else {
+      timers_.erase(it);
+    }
+    Invoke(context, callback, argv);
+  }
+  // For the timers that are not due yet
+  ScheduleWakeUp();
+}
+
+void V8Timers::RunIdleCallbacks() {
+  idleTickPending_ = false;
+  Clock::time_point deadline = Clock::now() + kMaxIdlePeriod;
+  // Leave room for the next timer
+  if (!schedule_.empty()) {
+    deadline = std::min(deadline, schedule_.begin()->first);
+  }
+
+  v8::Isolate *isolate = runtime_.isolate_;
+  v8::Locker locker(isolate);
+  v8::Isolate::Scope scopedIsolate(isolate);
+  v8::HandleScope scopedHandle(isolate);
+  v8::Local<v8::Context> context = runtime_.context_.Get(isolate);
+  v8::Context::Scope scopedContext(context);
+
+  v8::Local<v8::Object> idleDeadline = v8::Object::New(isolate);
+  idleDeadline
+      ->Set(
+          context,
+          v8::String::NewFromUtf8Literal(isolate, "didTimeout"),
+          v8::False(isolate))
+      .Check();
+  double deadlineMs = std::chrono::duration<double, std::milli>(
+                          deadline.time_since_epoch())
+                          .count();
+  idleDeadline
+      ->Set(
+          context,
+          v8::String::NewFromUtf8Literal(isolate, "timeRemaining"),
+          v8::Function::New(
+              context,
+              IdleDeadlineTimeRemaining,
+              v8::Number::New(isolate, deadlineMs))
+              .ToLocalChecked())
+      .Check();
+
+  // Callbacks requested from now on wait for the next idle tick
+  std::map<uint32_t, v8::Global<v8::Function>> idleCallbacks;
+  idleCallbacks.swap(idleCallbacks_);
+  for (auto &[id, callback] : idleCallbacks) {
+    std::vector<v8::Local<v8::Value>> argv{idleDeadline};
+    Invoke(context, callback.Get(isolate), argv);
+  }
+}
+
+void V8Timers::Invoke(
+    v8::Local<v8::Context> context,
+    v8::Local<v8::Function> callback,
+    std::vector<v8::Local<v8::Value>> &argv) {
+  v8::Isolate *isolate = context->GetIsolate();
+  v8::TryCatch tryCatch(isolate);
+  v8::MaybeLocal<v8::Value> result = callback->Call(
+      context,
+      context->Global(),
+      static_cast<int>(argv.size()),
+      argv.data());
+  if (result.IsEmpty() && tryCatch.HasCaught() && !tryCatch.HasTerminated()) {
+    LOG(ERROR) << "[rnv8] Uncaught error in timer callback: "
+               << JSIV8ValueConverter::ToSTLString(
+                      isolate, tryCatch.Exception());
+  }
+  // Like a task in browsers, each callback is followed by its microtasks
+  isolate->PerformMicrotaskCheckpoint();
+}
+
+} // namespace rnv8
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cxxreact/MessageQueueThread.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "v8.h"
+
+namespace rnv8 {
+
+class V8Runtime;
+
+// Native setTimeout/setInterval/requestIdleCallback for a runtime. A delayed
+// platform task posts a tick to the JS queue when the earliest timer is due,
+// and the tick runs every timer due by then, so timers due together cost one
+// JS queue task.
+class V8Timers final : public std::enable_shared_from_this<V8Timers> {
+ public:
+  explicit V8Timers(V8Runtime &runtime);
+  // Must be called with the isolate locked, it releases the callbacks
+  ~V8Timers();
+
+  V8Timers(const V8Timers &) = delete;
+  V8Timers &operator=(const V8Timers &) = delete;
+
+  // Adds the timer functions to the global template of a new context
+  void InstallGlobals(
+      v8::Isolate *isolate,
+      v8::Local<v8::ObjectTemplate> global);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Timer {
+    v8::Global<v8::Function> callback;
+    std::vector<v8::Global<v8::Value>> args;
+    Clock::duration interval;
+    bool repeat;
+    Clock::time_point deadline;
+  };
+
+  static void SetTimeout(const v8::FunctionCallbackInfo<v8::Value> &args);
+  static void SetInterval(const v8::FunctionCallbackInfo<v8::Value> &args);
+  static void ClearTimer(const v8::FunctionCallbackInfo<v8::Value> &args);
+  static void RequestIdleCallback(
+      const v8::FunctionCallbackInfo<v8::Value> &args);
+  static void CancelIdleCallback(
+      const v8::FunctionCallbackInfo<v8::Value> &args);
+
+  void AddTimer(const v8::FunctionCallbackInfo<v8::Value> &args, bool repeat);
+  void Schedule(uint32_t id, Clock::time_point deadline);
+  void Unschedule(uint32_t id, Clock::time_point deadline);
+  void ScheduleWakeUp();
+  void PostIdleTick();
+  void RunTimers();
+  void RunIdleCallbacks();
+  void Invoke(
+      v8::Local<v8::Context> context,
+      v8::Local<v8::Function> callback,
+      std::vector<v8::Local<v8::Value>> &argv);
+
+ private:
+  // Upper bound of `timeRemaining()` for idle callbacks, as in browsers
+  static constexpr auto kMaxIdlePeriod = std::chrono::milliseconds(50);
+  // Longer delays are clamped, about 24.8 days, so the deadline cannot
+  // overflow the clock
+  static constexpr double kMaxDelayMs = 2147483647;
+
+  V8Runtime &runtime_;
+
+  // Only accessed on the JS thread
+  uint32_t nextId_ = 1;
+  std::unordered_map<uint32_t, Timer> timers_;
+  std::map<uint32_t, v8::Global<v8::Function>> idleCallbacks_;
+  std::multimap<Clock::time_point, uint32_t> schedule_;
+  // Deadline of the earliest wake up task posted to the platform
+  Clock::time_point wakeUpTime_ = Clock::time_point::max();
+  bool idleTickPending_ = false;
+};
+
+} // namespace rnv8
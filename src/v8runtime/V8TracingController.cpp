@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8TracingController.h"
+
+#include <cxxreact/SystraceSection.h>
+#include <sstream>
+#include <vector>
+
+namespace rnv8 {
+
+namespace {
+
+// See `CategoryGroupEnabledFlags` of V8's trace event macros
+constexpr uint8_t kEnabledForRecording = 1 << 0;
+
+constexpr char kPhaseBegin = 'B';
+constexpr char kPhaseEnd = 'E';
+constexpr char kPhaseComplete = 'X';
+
+const char kDisabledByDefaultPrefix[] = "disabled-by-default-";
+
+// The open sections of the current thread, innermost last. V8 ends its
+// duration events in reverse order on the thread that began them.
+std::vector<std::unique_ptr<facebook::react::SystraceSection>> &
+GetThreadSections() {
+  thread_local std::vector<std::unique_ptr<facebook::react::SystraceSection>>
+      sections;
+  return sections;
+}
+
+void BeginSection(const char *name) {
+  auto &sections = GetThreadSections();
+  sections.push_back(std::make_unique<facebook::react::SystraceSection>(name));
+}
+
+void EndSection() {
+  auto &sections = GetThreadSections();
+  if (!sections.empty()) {
+    sections.pop_back();
+  }
+}
+
+} // namespace
+
+V8TracingController::V8TracingController(const std::string &categories) {
+  std::istringstream stream(categories);
+  std::string category;
+  while (std::getline(stream, category, ',')) {
+    if (!category.empty()) {
+      categories_.insert(category);
+    }
+  }
+}
+
+const uint8_t *V8TracingController::GetCategoryGroupEnabled(
+    const char *categoryGroup) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = categoryGroups_.find(categoryGroup);
+  if (it != categoryGroups_.end()) {
+    return &it->second;
+  }
+
+  bool enabled = false;
+  std::istringstream stream(categoryGroup);
+  std::string category;
+  while (!enabled && std::getline(stream, category, ',')) {
+    enabled = categories_.count(category) > 0 ||
+        (categories_.count("*") > 0 &&
+         category.rfind(kDisabledByDefaultPrefix, 0) != 0);
+  }
+  it = categoryGroups_
+           .emplace(categoryGroup, enabled ? kEnabledForRecording : 0)
+           .first;
+  return &it->second;
+}
+
+uint64_t V8TracingController::AddTraceEvent(
+    char phase,
+    const uint8_t *categoryEnabledFlag,
+    const char *name,
+    const char *scope,
+    uint64_t id,
+    uint64_t bindId,
+    int32_t numArgs,
+    const char **argNames,
+    const uint8_t *argTypes,
+    const uint64_t *argValues,
+    std::unique_ptr<v8::ConvertableToTraceFormat> *argConvertables,
+    unsigned int flags) {
+  switch (phase) {
+    case kPhaseBegin:
+      BeginSection(name);
+      return 0;
+    case kPhaseComplete:
+      BeginSection(name);
+      // The handle only has to be non-zero, sections end in order
+      return 1;
+    case kPhaseEnd:
+      EndSection();
+      return 0;
+    default:
+      return 0;
+  }
+}
+
+uint64_t V8TracingController::AddTraceEventWithTimestamp(
+    char phase,
+    const uint8_t *categoryEnabledFlag,
+    const char *name,
+    const char *scope,
+    uint64_t id,
+    uint64_t bindId,
+    int32_t numArgs,
+    const char **argNames,
+    const uint8_t *argTypes,
+    const uint64_t *argValues,
+    std::unique_ptr<v8::ConvertableToTraceFormat> *argConvertables,
+    unsigned int flags,
+    int64_t timestamp) {
+  // Systrace sections are always stamped with the current time
+  return AddTraceEvent(
+      phase,
+      categoryEnabledFlag,
+      name,
+      scope,
+      id,
+      bindId,
+      numArgs,
+      argNames,
+      argTypes,
+      argValues,
+      argConvertables,
+      flags);
+}
+
+void V8TracingController::UpdateTraceEventDuration(
+    const uint8_t *categoryEnabledFlag,
+    const char *name,
+    uint64_t handle) {
+  EndSection();
+}
+
+} // namespace rnv8
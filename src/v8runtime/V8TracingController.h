@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include "v8-platform.h"
+
+namespace rnv8 {
+
+// Routes the trace events of V8, e.g. parsing, compiling and GC phases, to
+// systrace sections on the thread emitting them. Only duration events are
+// routed. Has no effect when V8 is built with `v8_use_perfetto`.
+class V8TracingController final : public v8::TracingController {
+ public:
+  // `categories` is a comma separated list, e.g. "v8,v8.compile"
+  explicit V8TracingController(const std::string &categories);
+
+  //
+  // v8::TracingController implementations
+  //
+ public:
+  const uint8_t *GetCategoryGroupEnabled(const char *categoryGroup) override;
+  uint64_t AddTraceEvent(
+      char phase,
+      const uint8_t *categoryEnabledFlag,
+      const char *name,
+      const char *scope,
+      uint64_t id,
+      uint64_t bindId,
+      int32_t numArgs,
+      const char **argNames,
+      const uint8_t *argTypes,
+      const uint64_t *argValues,
+      std::unique_ptr<v8::ConvertableToTraceFormat> *argConvertables,
+      unsigned int flags) override;
+  uint64_t AddTraceEventWithTimestamp(
+      char phase,
+      const uint8_t *categoryEnabledFlag,
+      const char *name,
+      const char *scope,
+      uint64_t id,
+      uint64_t bindId,
+      int32_t numArgs,
+      const char **argNames,
+      const uint8_t *argTypes,
+      const uint64_t *argValues,
+      std::unique_ptr<v8::ConvertableToTraceFormat> *argConvertables,
+      unsigned int flags,
+      int64_t timestamp) override;
+  void UpdateTraceEventDuration(
+      const uint8_t *categoryEnabledFlag,
+      const char *name,
+      uint64_t handle) override;
+
+ private:
+  std::set<std::string> categories_;
+
+  std::mutex mutex_; // protects categoryGroups_
+  // The flags are read by V8 without the lock, the map nodes never move
+  std::map<std::string, uint8_t> categoryGroups_;
+};
+
+} // namespace rnv8
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "V8Watchdog.h"
+
+#include <glog/logging.h>
+#include <pthread.h>
+#include <sstream>
+#include "JSIV8ValueConverter.h"
+
+namespace rnv8 {
+
+namespace {
+
+struct InterruptData {
+  std::weak_ptr<V8Watchdog> watchdog;
+  uint64_t generation;
+};
+
+} // namespace
+
+V8Watchdog::V8Watchdog(v8::Isolate *isolate, uint32_t timeoutMs, bool terminate)
+    : isolate_(isolate), timeoutMs_(timeoutMs), terminate_(terminate) {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+V8Watchdog::~V8Watchdog() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  condition_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+V8Watchdog::Scope::Scope(V8Watchdog *watchdog) : watchdog_(watchdog) {
+  if (watchdog_) {
+    watchdog_->Enter();
+  }
+}
+
+V8Watchdog::Scope::~Scope() {
+  if (watchdog_) {
+    watchdog_->Leave();
+  }
+}
+
+bool V8Watchdog::CancelTerminationIfNeeded() {
+  // Nested calls keep unwinding until the outermost call is reached
+  if (!terminated_ || depth_ != 1) {
+    return false;
+  }
+  terminated_ = false;
+  isolate_->CancelTerminateExecution();
+  return true;
+}
+
+void V8Watchdog::Enter() {
+  if (depth_++ > 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    armed_ = true;
+    deadline_ = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(timeoutMs_);
+  }
+  condition_.notify_one();
+}
+
+void V8Watchdog::Leave() {
+  if (--depth_ > 0) {
+    return;
+  }
+  terminated_ = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    armed_ = false;
+  }
+  condition_.notify_one();
+}
+
+void V8Watchdog::Run() {
+#if defined(__APPLE__)
+  pthread_setname_np("rnv8-watchdog");
+#elif defined(__ANDROID__)
+  pthread_setname_np(pthread_self(), "rnv8-watchdog");
+#endif
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    if (!armed_) {
+      condition_.wait(lock);
+      continue;
+    }
+
+    uint64_t generation = generation_;
+    if (condition_.wait_until(lock, deadline_, [this, generation]() {
+          return stopped_ || generation_ != generation;
+        })) {
+      continue;
+    }
+
+    // The interrupt is serviced at the next stack guard check of the JS
+    // thread. The data is leaked if the isolate goes away first.
+    isolate_->RequestInterrupt(
+        &V8Watchdog::OnInterrupt,
+        new InterruptData{weak_from_this(), generation});
+
+    // Report a long task only once
+    condition_.wait(lock, [this, generation]() {
+      return stopped_ || generation_ != generation;
+    });
+  }
+}
+
+// static
+void V8Watchdog::OnInterrupt(v8::Isolate *isolate, void *data) {
+  std::unique_ptr<InterruptData> interruptData(
+      static_cast<InterruptData *>(data));
+  if (auto watchdog = interruptData->watchdog.lock()) {
+    watchdog->HandleInterrupt(interruptData->generation);
+  }
+}
+
+void V8Watchdog::HandleInterrupt(uint64_t generation) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_) {
+      // The long task finished before the interrupt was serviced
+      return;
+    }
+  }
+
+  std::ostringstream ss;
+  ss << "[rnv8] Long task: JS thread blocked for more than " << timeoutMs_
+     << "ms";
+  v8::HandleScope scopedHandle(isolate_);
+  v8::Local<v8::StackTrace> stackTrace =
+      v8::StackTrace::CurrentStackTrace(isolate_, kMaxStackFrames);
+  for (int i = 0; i < stackTrace->GetFrameCount(); ++i) {
+    v8::Local<v8::StackFrame> frame = stackTrace->GetFrame(isolate_, i);
+    ss << "\n    at ";
+    v8::Local<v8::String> functionName = frame->GetFunctionName();
+    if (!functionName.IsEmpty() && functionName->Length() > 0) {
+      ss << JSIV8ValueConverter::ToSTLString(isolate_, functionName) << " ";
+    }
+    v8::Local<v8::String> scriptName = frame->GetScriptNameOrSourceURL();
+    ss << "("
+       << (scriptName.IsEmpty()
+               ? "<anonymous>"
+               : JSIV8ValueConverter::ToSTLString(isolate_, scriptName))
+       << ":" << frame->GetLineNumber() << ":" << frame->GetColumn() << ")";
+  }
+  LOG(WARNING) << ss.str();
+
+  if (terminate_) {
+    terminated_ = true;
+    isolate_->TerminateExecution();
+  }
+}
+
+} // namespace rnv8
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Kudo Chien.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "v8.h"
+
+namespace rnv8 {
+
+// Watches JSI calls into JS from a background thread. When the outermost call
+// runs longer than the timeout, the JS thread is interrupted to log the
+// current JS stack as a long task report, and optionally to terminate the
+// execution.
+class V8Watchdog final : public std::enable_shared_from_this<V8Watchdog> {
+ public:
+  V8Watchdog(v8::Isolate *isolate, uint32_t timeoutMs, bool terminate);
+  ~V8Watchdog();
+
+  V8Watchdog(const V8Watchdog &) = delete;
+  V8Watchdog &operator=(const V8Watchdog &) = delete;
+
+  // Tracks one JSI call on the JS thread. Only the outermost call is timed.
+  class Scope final {
+   public:
+    explicit Scope(V8Watchdog *watchdog);
+    ~Scope();
+
+   private:
+    V8Watchdog *watchdog_;
+  };
+
+  // For a termination caught by a JSI call: returns true and cancels the
+  // termination when the watchdog terminated the execution and the call is
+  // the outermost one, so the runtime can be used again.
+  bool CancelTerminationIfNeeded();
+
+  uint32_t GetTimeoutMs() const {
+    return timeoutMs_;
+  }
+
+ private:
+  void Enter();
+  void Leave();
+  void Run();
+
+  static void OnInterrupt(v8::Isolate *isolate, void *data);
+  void HandleInterrupt(uint64_t generation);
+
+ private:
+  static constexpr int kMaxStackFrames = 16;
+
+  v8::Isolate *isolate_;
+  const uint32_t timeoutMs_;
+  const bool terminate_;
+
+  // Only accessed on the JS thread
+  int depth_ = 0;
+  bool terminated_ = false;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  // Increased on every enter and leave of the outermost call
+  uint64_t generation_ = 0;
+  bool armed_ = false;
+  std::chrono::steady_clock::time_point deadline_;
+  bool stopped_ = false;
+};
+
+} // namespace rnv8